@@ -0,0 +1,182 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file benchmark.cpp
+ * The code of the fraction_bench harness.
+ */
+
+#include <climits>
+#include <cstdio>
+
+#include "benchmark.hpp"
+#include "instrumentation.hpp"
+
+namespace npasson {
+	namespace bench {
+
+		const char* name(Distribution dist) {
+			switch (dist) {
+				case Distribution::small:         return "small";
+				case Distribution::large:         return "large";
+				case Distribution::near_overflow: return "near_overflow";
+			}
+			return "";
+		}
+
+		/**
+		 * @return A uniformly distributed integer in <tt>[lo, hi]</tt>.
+		 */
+		long long signed int Random::range(long long signed int lo, long long signed int hi) {
+			unsigned long long span = static_cast<unsigned long long>(hi) - static_cast<unsigned long long>(lo);
+			if (span == ULLONG_MAX) return static_cast<long long signed int>(engine());
+			++span;
+			// reject the top partial block so every residue is equally likely
+			unsigned long long limit = ULLONG_MAX - ULLONG_MAX % span;
+			unsigned long long x;
+			do {
+				x = engine();
+			} while (x >= limit);
+			return static_cast<long long signed int>(static_cast<unsigned long long>(lo) + x % span);
+		}
+
+		long long signed int Random::positive(Distribution dist) {
+			switch (dist) {
+				case Distribution::small:         return range(1, 1000);
+				case Distribution::large:         return range(1, 1ll << 40);
+				case Distribution::near_overflow: return range(1ll << 62, LLONG_MAX);
+			}
+			return 1;
+		}
+
+		long long signed int Random::integer(Distribution dist) {
+			long long signed int magnitude = (dist == Distribution::small) ? range(0, 1000) : positive(dist);
+			return (engine() & 1) ? -magnitude : magnitude;
+		}
+
+		Fraction Random::fraction(Distribution dist) {
+			long long signed int num = integer(dist);
+			return Fraction(num, positive(dist));
+		}
+
+		/**
+		 * The Fraction(double) constructor goes through a decimal string with six fractional digits, so
+		 * <tt>near_overflow</tt> stays below 2^43, where that string no longer fits in 64 bits.
+		 */
+		double Random::floating(Distribution dist) {
+			double sign = (engine() & 1) ? -1.0 : 1.0;
+			switch (dist) {
+				case Distribution::small:         return sign * uniform() * 1000.0;
+				case Distribution::large:         return sign * uniform() * 2147483648.0;
+				case Distribution::near_overflow: return sign * (1.0 + uniform()) * 4398046511104.0;
+			}
+			return 0;
+		}
+
+		/**
+		 * @return A decimal string in the form the string constructor takes, e.g. <tt>-12.0500</tt>.
+		 */
+		std::string Random::decimal(Distribution dist) {
+			long long signed int whole = 0;
+			int digits = 3;
+			switch (dist) {
+				case Distribution::small:         whole = range(0, 999); break;
+				case Distribution::large:         whole = range(0, 2147483647); digits = 6; break;
+				case Distribution::near_overflow: whole = range(1ll << 42, 1ll << 43); digits = 6; break;
+			}
+			std::string fraction_digits;
+			for (int i = 0; i < digits; ++i) fraction_digits += static_cast<char>('0' + range(0, 9));
+			return ((engine() & 1) ? "-" : "") + std::to_string(whole) + "." + fraction_digits;
+		}
+
+		volatile unsigned long long Suite::sink = 0;
+
+		Suite::Suite(unsigned long long seed, std::string filter, std::size_t inputs, double min_time_ms)
+		: seed(seed), filter(std::move(filter)), inputs(inputs ? inputs : 1), min_time_ns(min_time_ms * 1e6) {}
+
+		std::string Suite::key(const std::string &case_name, const std::string &distribution) {
+			return distribution.empty() ? case_name : case_name + "/" + distribution;
+		}
+
+		/**
+		 * @return If the filter is empty or a substring of <tt>case/distribution</tt>.
+		 */
+		bool Suite::enabled(const std::string &case_name, const std::string &distribution) const {
+			return filter.empty() || key(case_name, distribution).find(filter) != std::string::npos;
+		}
+
+		/**
+		 * @return A Random seeded from the suite seed and an FNV-1a hash of the case name, which unlike std::hash is
+		 * the same everywhere.
+		 */
+		Random Suite::random(const std::string &case_name, const std::string &distribution) const {
+			unsigned long long hash = 14695981039346656037ull;
+			for (char c : key(case_name, distribution)) {
+				hash ^= static_cast<unsigned char>(c);
+				hash *= 1099511628211ull;
+			}
+			return Random(seed ^ hash);
+		}
+
+		namespace {
+			std::string quoted(const std::string &str) {
+				std::string result = "\"";
+				for (char c : str) {
+					if (c == '"' || c == '\\') result += '\\';
+					result += c;
+				}
+				return result + "\"";
+			}
+		}
+
+		/**
+		 * Writes the results as one JSON object, with ns/op per case and distribution, and the instrumentation
+		 * counters if they are compiled in.
+		 */
+		void Suite::write_json(std::ostream &out) const {
+#if defined(__VERSION__)
+			const char* compiler = __VERSION__;
+#else
+			const char* compiler = "unknown";
+#endif
+			out << "{\n";
+			out << "\t\"suite\": \"fraction_bench\",\n";
+			out << "\t\"seed\": " << seed << ",\n";
+			out << "\t\"inputs\": " << inputs << ",\n";
+			out << "\t\"compiler\": " << quoted(compiler) << ",\n";
+			out << "\t\"cplusplus\": " << __cplusplus << ",\n";
+#ifdef NPASSON_INSTRUMENT
+			// the timings include the instrumentation; the worker threads of the threaded cases have been joined, so
+			// their counters are in the totals
+			out << "\t\"counters\": " << all_fraction_counters().json() << ",\n";
+#endif
+			out << "\t\"results\": [";
+			for (std::size_t i = 0; i < results.size(); ++i) {
+				char ns[32];
+				std::snprintf(ns, sizeof(ns), "%.3f", results[i].ns_per_op);
+				out << (i ? ",\n" : "\n") << "\t\t{\"name\": " << quoted(results[i].name);
+				if (!results[i].distribution.empty()) out << ", \"distribution\": " << quoted(results[i].distribution);
+				out << ", \"ops\": " << results[i].ops << ", \"ns_per_op\": " << ns << "}";
+			}
+			out << "\n\t]\n}\n";
+		}
+	}
+}
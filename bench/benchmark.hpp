@@ -0,0 +1,164 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file benchmark.hpp
+ * The harness of fraction_bench: seeded input distributions, timing and JSON output.
+ */
+
+#ifndef NPASSON_BENCHMARK_HPP
+#define NPASSON_BENCHMARK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fraction.hpp"
+
+namespace npasson {
+	namespace bench {
+
+		/**
+		 * Operand magnitudes. <tt>near_overflow</tt> puts numerators and denominators just below the 64 bit limit,
+		 * so most results take the overflow paths.
+		 */
+		enum class Distribution {
+			small,
+			large,
+			near_overflow
+		};
+
+		const char* name(Distribution);
+
+		/**
+		 * \brief A seeded random source that yields the same numbers on every platform.
+		 *
+		 * The output of <tt>std::mt19937_64</tt> is fixed by the standard, but the standard distributions are not,
+		 * so the ranges are mapped here.
+		 */
+		class Random {
+
+		private:
+			std::mt19937_64 engine;
+
+		public:
+			explicit Random(unsigned long long seed) : engine(seed) {}
+
+			unsigned long long bits() {return engine();}
+			long long signed int range(long long signed int, long long signed int);
+			double uniform() {return static_cast<double>(engine() >> 11) / 9007199254740992.0;}
+
+			long long signed int integer(Distribution);
+			long long signed int positive(Distribution);
+			Fraction fraction(Distribution);
+			double floating(Distribution);
+			std::string decimal(Distribution);
+		};
+
+		/**
+		 * The time per operation of one benchmark case.
+		 */
+		struct Result {
+			std::string name;
+			std::string distribution;
+			std::size_t ops;
+			double      ns_per_op;
+		};
+
+		/**
+		 * \brief Runs benchmark cases and collects their results.
+		 *
+		 * Every case gets its own Random, seeded from the suite seed and the case name, so a case sees the same
+		 * inputs whether it runs alone or as part of the whole suite.
+		 */
+		class Suite {
+
+		private:
+			unsigned long long seed;
+			std::string        filter;
+			std::size_t        inputs;
+			double             min_time_ns;
+			std::vector<Result> results;
+
+			static volatile unsigned long long sink;
+
+			static std::string key(const std::string&, const std::string&);
+
+		public:
+			Suite(unsigned long long seed, std::string filter, std::size_t inputs, double min_time_ms);
+
+			std::size_t size() const {return inputs;}
+
+			bool enabled(const std::string&, const std::string& = "") const;
+			Random random(const std::string&, const std::string& = "") const;
+
+			/**
+			 * \brief Times <tt>body</tt>, which performs <tt>ops</tt> operations per call.
+			 *
+			 * The body is called once to warm up and then repeatedly until the minimum time has passed. It returns a
+			 * checksum of its results, which is kept so the work cannot be optimized away.
+			 */
+			template <typename F>
+			void run(const std::string &case_name, const std::string &distribution, std::size_t ops, F body) {
+				if (!enabled(case_name, distribution)) return;
+				typedef std::chrono::steady_clock clock;
+				unsigned long long checksum = body();
+				std::size_t calls = 0;
+				double elapsed = 0;
+				clock::time_point start = clock::now();
+				do {
+					checksum ^= body();
+					++calls;
+					elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+				} while (elapsed < min_time_ns);
+				sink = sink ^ checksum;
+				Result result = {case_name, distribution, ops * calls, elapsed / static_cast<double>(ops * calls)};
+				results.push_back(result);
+			}
+
+			void write_json(std::ostream&) const;
+		};
+
+		/**
+		 * Folds a result into a checksum.
+		 */
+		inline unsigned long long checksum(const Fraction &frac) {
+			return static_cast<unsigned long long>(frac.num()) * 31u + static_cast<unsigned long long>(frac.den());
+		}
+		inline unsigned long long checksum(long long signed int value) {return static_cast<unsigned long long>(value);}
+		inline unsigned long long checksum(bool value) {return value ? 1u : 0u;}
+		inline unsigned long long checksum(double value) {
+			unsigned long long bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+		inline unsigned long long checksum(const std::string &str) {return str.size() + (str.empty() ? 0u : str[0]);}
+
+		void fraction_benchmarks(Suite&);
+		void component_benchmarks(Suite&);
+	}
+}
+
+#endif //NPASSON_BENCHMARK_HPP
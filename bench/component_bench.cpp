@@ -0,0 +1,429 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file component_bench.cpp
+ * Benchmarks of the components built on Fraction, each next to the plain Fraction route it replaces.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "atomic_fraction.hpp"
+#include "continued_fraction.hpp"
+#include "dyadic_fraction.hpp"
+#include "filtered_fraction.hpp"
+#include "fixed_fraction.hpp"
+#include "fraction_expression.hpp"
+#include "fraction_map.hpp"
+#include "fraction_polynomial.hpp"
+#include "group_by.hpp"
+#include "lattice.hpp"
+#include "predicates.hpp"
+
+namespace npasson {
+	namespace bench {
+
+		namespace {
+			const Distribution distributions[] = {Distribution::small, Distribution::large, Distribution::near_overflow};
+
+			std::vector<Fraction> fractions(Random &random, Distribution dist, std::size_t count) {
+				std::vector<Fraction> result;
+				for (std::size_t i = 0; i < count; ++i) result.push_back(random.fraction(dist));
+				return result;
+			}
+
+			/**
+			 * Sorting through double shadows against std::sort on Fraction.
+			 */
+			void filtered(Suite &suite) {
+				for (Distribution dist : distributions) {
+					Random random = suite.random("sort", name(dist));
+					std::vector<Fraction> input = fractions(random, dist, suite.size() * 64);
+					std::vector<Fraction> work;
+					suite.run("sort.fraction", name(dist), input.size(), [&]() {
+						work = input;
+						std::sort(work.begin(), work.end());
+						return checksum(work.front());
+					});
+					suite.run("sort.filtered", name(dist), input.size(), [&]() {
+						work = input;
+						FilteredFraction::sort(work.data(), work.size());
+						return checksum(work.front());
+					});
+				}
+			}
+
+			/**
+			 * Predicates on random points, where the filter decides, and on collinear or cocircular points, where
+			 * every call takes the exact path.
+			 */
+			void predicates(Suite &suite) {
+				Random random = suite.random("predicates");
+				std::vector<Point2> points, line, circle;
+				for (std::size_t i = 0; i < suite.size() + 3; ++i) {
+					points.push_back(Point2{random.fraction(Distribution::small), random.fraction(Distribution::small)});
+					Fraction x = random.fraction(Distribution::small);
+					line.push_back(Point2{x, Fraction(3, 7) * x + Fraction(1, 3)});
+				}
+				// points on the unit circle from Pythagorean triples
+				for (std::size_t i = 0; i < suite.size() + 3; ++i) {
+					long long signed int m = random.range(1, 40), n = random.range(0, m - 1);
+					circle.push_back(Point2{Fraction(m * m - n * n, m * m + n * n), Fraction(2 * m * n, m * m + n * n)});
+				}
+				const std::size_t count = suite.size();
+				suite.run("predicates.orient2d", "random", count, [&]() {
+					unsigned long long sum = 0;
+					for (std::size_t i = 0; i < count; ++i) sum += static_cast<unsigned long long>(orient2d(points[i], points[i + 1], points[i + 2]) + 1);
+					return sum;
+				});
+				suite.run("predicates.orient2d", "degenerate", count, [&]() {
+					unsigned long long sum = 0;
+					for (std::size_t i = 0; i < count; ++i) sum += static_cast<unsigned long long>(orient2d(line[i], line[i + 1], line[i + 2]) + 1);
+					return sum;
+				});
+				suite.run("predicates.incircle", "random", count, [&]() {
+					unsigned long long sum = 0;
+					for (std::size_t i = 0; i < count; ++i) sum += static_cast<unsigned long long>(incircle(points[i], points[i + 1], points[i + 2], points[i + 3]) + 1);
+					return sum;
+				});
+				suite.run("predicates.incircle", "degenerate", count, [&]() {
+					unsigned long long sum = 0;
+					for (std::size_t i = 0; i < count; ++i) sum += static_cast<unsigned long long>(incircle(circle[i], circle[i + 1], circle[i + 2], circle[i + 3]) + 1);
+					return sum;
+				});
+			}
+
+			/**
+			 * <tt>a*b + c*d</tt> through the operators, an expression template and fmma().
+			 */
+			void expressions(Suite &suite) {
+				for (Distribution dist : distributions) {
+					Random random = suite.random("expr", name(dist));
+					std::vector<Fraction> a = fractions(random, dist, suite.size()), b = fractions(random, dist, suite.size());
+					std::vector<Fraction> c = fractions(random, dist, suite.size()), d = fractions(random, dist, suite.size());
+					suite.run("expr.operators", name(dist), a.size(), [&]() {
+						unsigned long long sum = 0;
+						for (std::size_t i = 0; i < a.size(); ++i) sum += checksum(a[i] * b[i] + c[i] * d[i]);
+						return sum;
+					});
+					suite.run("expr.lazy", name(dist), a.size(), [&]() {
+						unsigned long long sum = 0;
+						for (std::size_t i = 0; i < a.size(); ++i) sum += checksum((lazy(a[i]) * b[i] + lazy(c[i]) * d[i]).eval());
+						return sum;
+					});
+					suite.run("expr.fmma", name(dist), a.size(), [&]() {
+						unsigned long long sum = 0;
+						for (std::size_t i = 0; i < a.size(); ++i) sum += checksum(fmma(a[i], b[i], c[i], d[i]));
+						return sum;
+					});
+				}
+			}
+
+			/**
+			 * Sums and products of prices with six decimals, as FixedFraction, DyadicFraction and Fraction.
+			 */
+			void fixed_point(Suite &suite) {
+				typedef FixedFraction<1000000> Micro;
+				Random random = suite.random("fixed");
+				std::vector<Micro> fixed;
+				std::vector<Fraction> plain;
+				std::vector<DyadicFraction> dyadic;
+				for (std::size_t i = 0; i < suite.size(); ++i) {
+					long long signed int units = random.range(-1000000000, 1000000000);
+					fixed.push_back(Micro::from_units(units));
+					plain.push_back(Fraction(units, 1000000));
+					dyadic.push_back(DyadicFraction::from_parts(units, -20));
+				}
+				suite.run("fixed.sum", "", fixed.size(), [&]() {
+					return checksum(Micro::sum(fixed.data(), fixed.size()).to_fraction());
+				});
+				suite.run("fixed.mul", "", fixed.size(), [&]() {
+					unsigned long long sum = 0;
+					for (std::size_t i = 0; i + 1 < fixed.size(); ++i) sum += checksum((fixed[i] * fixed[i + 1]).to_fraction());
+					return sum;
+				});
+				suite.run("dyadic.sum", "", dyadic.size(), [&]() {
+					DyadicFraction total(0ll);
+					for (const DyadicFraction &x : dyadic) total += x;
+					return checksum(total.to_double());
+				});
+				suite.run("dyadic.mul", "", dyadic.size(), [&]() {
+					unsigned long long sum = 0;
+					for (std::size_t i = 0; i + 1 < dyadic.size(); ++i) sum += checksum((dyadic[i] * dyadic[i + 1]).to_double());
+					return sum;
+				});
+				suite.run("fixed.fraction_sum", "", plain.size(), [&]() {
+					Fraction total(0);
+					for (const Fraction &x : plain) total += x;
+					return checksum(total);
+				});
+				suite.run("fixed.fraction_mul", "", plain.size(), [&]() {
+					unsigned long long sum = 0;
+					for (std::size_t i = 0; i + 1 < plain.size(); ++i) sum += checksum(plain[i] * plain[i + 1]);
+					return sum;
+				});
+			}
+
+			/**
+			 * Reducing constructions with operands inside the default gcd table (below 256) and outside it.
+			 */
+			void gcd_table(Suite &suite) {
+				const char* ranges[] = {"table", "euclid"};
+				for (int r = 0; r < 2; ++r) {
+					Random random = suite.random("gcd.construct", ranges[r]);
+					long long signed int lo = r ? 256 : 1, hi = r ? 65535 : 255;
+					std::vector<long long signed int> num, den;
+					for (std::size_t i = 0; i < suite.size(); ++i) {
+						num.push_back(random.range(lo, hi));
+						den.push_back(random.range(lo, hi));
+					}
+					suite.run("gcd.construct", ranges[r], num.size(), [&]() {
+						unsigned long long sum = 0;
+						for (std::size_t i = 0; i < num.size(); ++i) sum += checksum(Fraction(num[i], den[i]));
+						return sum;
+					});
+				}
+			}
+
+			/**
+			 * Contended sums from 1 up to 64 threads through AtomicFraction, the sharded accumulator and a mutex.
+			 */
+			void contention(Suite &suite) {
+				unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+				const std::size_t per_thread = suite.size() * 16;
+				for (unsigned int threads = 1; threads <= 64 && threads <= 2 * hardware; threads *= 2) {
+					std::string label = "threads_" + std::to_string(threads);
+					// denominators divide 64, so the totals stay small however many values are added
+					Random random = suite.random("contention", label);
+					std::vector<Fraction> values;
+					for (std::size_t i = 0; i < per_thread; ++i) values.push_back(Fraction(random.range(-100, 100), 64));
+
+					AtomicFraction atomic;
+					suite.run("atomic.fetch_add", label, per_thread * threads, [&]() {
+						atomic.store(Fraction(0));
+						std::vector<std::thread> pool;
+						for (unsigned int t = 0; t < threads; ++t) {
+							pool.push_back(std::thread([&]() {for (const Fraction &x : values) atomic.fetch_add(x);}));
+						}
+						for (std::thread &thread : pool) thread.join();
+						return checksum(atomic.load());
+					});
+
+					ShardedFractionAccumulator sharded;
+					suite.run("sharded.add", label, per_thread * threads, [&]() {
+						sharded.reset();
+						std::vector<std::thread> pool;
+						for (unsigned int t = 0; t < threads; ++t) {
+							pool.push_back(std::thread([&]() {for (const Fraction &x : values) sharded.add(x);}));
+						}
+						for (std::thread &thread : pool) thread.join();
+						return checksum(sharded.load());
+					});
+
+					Fraction total;
+					std::mutex mutex;
+					suite.run("mutex.add", label, per_thread * threads, [&]() {
+						total = Fraction(0);
+						std::vector<std::thread> pool;
+						for (unsigned int t = 0; t < threads; ++t) {
+							pool.push_back(std::thread([&]() {
+								for (const Fraction &x : values) {
+									std::lock_guard<std::mutex> lock(mutex);
+									total += x;
+								}
+							}));
+						}
+						for (std::thread &thread : pool) thread.join();
+						return checksum(total);
+					});
+				}
+			}
+
+			/**
+			 * FractionMap against std::unordered_map, and grouped aggregation on one and four threads.
+			 */
+			void maps(Suite &suite) {
+				for (Distribution dist : distributions) {
+					Random random = suite.random("map", name(dist));
+					std::vector<Fraction> keys = fractions(random, dist, suite.size());
+					FractionMap<long long signed int> map;
+					std::unordered_map<Fraction, long long signed int> reference;
+					suite.run("map.insert", name(dist), keys.size(), [&]() {
+						map.clear();
+						for (std::size_t i = 0; i < keys.size(); ++i) map[keys[i]] += static_cast<long long signed int>(i);
+						return static_cast<unsigned long long>(map.size());
+					});
+					suite.run("map.find", name(dist), keys.size(), [&]() {
+						unsigned long long sum = 0;
+						for (const Fraction &key : keys) sum += static_cast<unsigned long long>(*map.find(key));
+						return sum;
+					});
+					suite.run("unordered_map.insert", name(dist), keys.size(), [&]() {
+						reference.clear();
+						for (std::size_t i = 0; i < keys.size(); ++i) reference[keys[i]] += static_cast<long long signed int>(i);
+						return static_cast<unsigned long long>(reference.size());
+					});
+					suite.run("unordered_map.find", name(dist), keys.size(), [&]() {
+						unsigned long long sum = 0;
+						for (const Fraction &key : keys) sum += static_cast<unsigned long long>(reference.find(key)->second);
+						return sum;
+					});
+				}
+
+				Random random = suite.random("group_by");
+				std::vector<Fraction> keys, values;
+				for (std::size_t i = 0; i < suite.size() * 16; ++i) {
+					keys.push_back(Fraction(random.range(0, 255), 8));
+					values.push_back(Fraction(random.range(-1000, 1000), 16));
+				}
+				for (unsigned int threads = 1; threads <= 4; threads *= 4) {
+					suite.run("group_by.add", "threads_" + std::to_string(threads), keys.size(), [&]() {
+						FractionGroupBy groups(16);
+						groups.add(keys.data(), values.data(), keys.size(), threads);
+						return static_cast<unsigned long long>(groups.size());
+					});
+				}
+			}
+
+			/**
+			 * Products and evaluation of polynomials of degree 10 to 1000 with small coefficients.
+			 */
+			void polynomials(Suite &suite) {
+				const std::size_t degrees[] = {10, 100, 1000};
+				for (std::size_t degree : degrees) {
+					std::string label = "degree_" + std::to_string(degree);
+					Random random = suite.random("poly", label);
+					std::vector<Fraction> a, b;
+					for (std::size_t i = 0; i <= degree; ++i) {
+						a.push_back(Fraction(random.range(-100, 100), random.range(1, 8)));
+						b.push_back(Fraction(random.range(-100, 100), random.range(1, 8)));
+					}
+					FractionPolynomial p(a), q(b);
+					suite.run("poly.mul", label, 1, [&]() {
+						return checksum((p * q)[degree]);
+					});
+					std::vector<Fraction> points, out(suite.size());
+					for (std::size_t i = 0; i < suite.size(); ++i) points.push_back(Fraction(random.range(-8, 8), 8));
+					suite.run("poly.evaluate", label, points.size(), [&]() {
+						unsigned long long sum = 0;
+						for (const Fraction &x : points) sum += checksum(p.evaluate(x));
+						return sum;
+					});
+					suite.run("poly.evaluate.batch", label, points.size(), [&]() {
+						p.evaluate(points.data(), out.data(), points.size());
+						unsigned long long sum = 0;
+						for (const Fraction &y : out) sum += checksum(y);
+						return sum;
+					});
+				}
+			}
+
+			/**
+			 * Exact square roots against the route through double, which yields six decimals at most.
+			 */
+			void roots(Suite &suite) {
+				for (Distribution dist : distributions) {
+					Random random = suite.random("root", name(dist));
+					std::vector<Fraction> input;
+					for (std::size_t i = 0; i < suite.size(); ++i) input.push_back(Fraction(random.positive(dist), random.positive(dist)));
+					suite.run("root.sqrt", name(dist), input.size(), [&]() {
+						unsigned long long sum = 0;
+						for (const Fraction &x : input) sum += checksum(x.sqrt(1000000ll));
+						return sum;
+					});
+					suite.run("root.double_route", name(dist), input.size(), [&]() {
+						unsigned long long sum = 0;
+						for (const Fraction &x : input) sum += checksum(Fraction(std::sqrt(x.to_double())));
+						return sum;
+					});
+				}
+			}
+
+			/**
+			 * Terms of square roots and of Gosper sums, and decimal expansion.
+			 */
+			void continued_fractions(Suite &suite) {
+				Random random = suite.random("cf");
+				std::vector<long long signed int> radicands;
+				for (std::size_t i = 0; i < 16; ++i) radicands.push_back(random.range(2, 1000000));
+				suite.run("cf.sqrt_terms", "", radicands.size() * 64, [&]() {
+					unsigned long long sum = 0;
+					for (long long signed int d : radicands) sum += ContinuedFraction::sqrt(Fraction(d)).terms(64).size();
+					return sum;
+				});
+				suite.run("cf.gosper_add_terms", "", 32, [&]() {
+					ContinuedFraction sum = ContinuedFraction::sqrt(Fraction(2)) + ContinuedFraction::sqrt(Fraction(3));
+					return static_cast<unsigned long long>(sum.terms(32).size());
+				});
+				suite.run("cf.decimal_digits", "", 100, [&]() {
+					return static_cast<unsigned long long>(ContinuedFraction::sqrt(Fraction(2)).decimal(100).size());
+				});
+			}
+
+			/**
+			 * Exact and guided LLL on knapsack lattices: rows (e_i | a_i) with random 40 bit a_i.
+			 */
+			void lattices(Suite &suite) {
+				const std::size_t dimensions[] = {10, 20};
+				for (std::size_t n : dimensions) {
+					std::string label = "knapsack_n" + std::to_string(n);
+					Random random = suite.random("lattice", label);
+					std::vector<std::vector<BigInteger>> rows(n, std::vector<BigInteger>(n + 1, BigInteger(0)));
+					for (std::size_t i = 0; i < n; ++i) {
+						rows[i][i] = BigInteger(1);
+						rows[i][n] = BigInteger(random.range(1, 1ll << 40));
+					}
+					suite.run("lattice.lll", label, 1, [&]() {
+						Lattice lattice(rows);
+						lattice.lll(Fraction(99, 100));
+						return static_cast<unsigned long long>(lattice.size());
+					});
+					suite.run("lattice.lll_guided", label, 1, [&]() {
+						Lattice lattice(rows);
+						lattice.lll_guided(Fraction(99, 100));
+						return static_cast<unsigned long long>(lattice.size());
+					});
+				}
+			}
+		}
+
+		void component_benchmarks(Suite &suite) {
+			filtered(suite);
+			predicates(suite);
+			expressions(suite);
+			fixed_point(suite);
+			gcd_table(suite);
+			contention(suite);
+			maps(suite);
+			polynomials(suite);
+			roots(suite);
+			continued_fractions(suite);
+			lattices(suite);
+		}
+	}
+}
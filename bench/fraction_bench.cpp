@@ -0,0 +1,344 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file fraction_bench.cpp
+ * The entry point of fraction_bench and the benchmarks of the Fraction class itself.
+ *
+ * Usage: <tt>fraction_bench [--seed N] [--filter TEXT] [--size N] [--min-time MS] [--output FILE] [--help]</tt>
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+
+namespace npasson {
+	namespace bench {
+
+		namespace {
+			const Distribution distributions[] = {Distribution::small, Distribution::large, Distribution::near_overflow};
+
+			/**
+			 * Times <tt>op(a[i], b[i])</tt> over random Fraction pairs of each distribution.
+			 */
+			template <typename Op>
+			void binary(Suite &suite, const std::string &case_name, Op op) {
+				for (Distribution dist : distributions) {
+					if (!suite.enabled(case_name, name(dist))) continue;
+					Random random = suite.random(case_name, name(dist));
+					std::vector<Fraction> a, b;
+					for (std::size_t i = 0; i < suite.size(); ++i) {
+						a.push_back(random.fraction(dist));
+						b.push_back(random.fraction(dist));
+					}
+					suite.run(case_name, name(dist), a.size(), [&]() {
+						unsigned long long sum = 0;
+						for (std::size_t i = 0; i < a.size(); ++i) sum += checksum(op(a[i], b[i]));
+						return sum;
+					});
+				}
+			}
+
+			/**
+			 * Times <tt>op(a[i])</tt> over random Fractions of each distribution.
+			 */
+			template <typename Op>
+			void unary(Suite &suite, const std::string &case_name, Op op) {
+				for (Distribution dist : distributions) {
+					if (!suite.enabled(case_name, name(dist))) continue;
+					Random random = suite.random(case_name, name(dist));
+					std::vector<Fraction> a;
+					for (std::size_t i = 0; i < suite.size(); ++i) a.push_back(random.fraction(dist));
+					suite.run(case_name, name(dist), a.size(), [&]() {
+						unsigned long long sum = 0;
+						for (std::size_t i = 0; i < a.size(); ++i) sum += checksum(op(a[i]));
+						return sum;
+					});
+				}
+			}
+
+			/**
+			 * Times the constructor from <tt>T</tt>, fed with <tt>random.integer()</tt> cast to <tt>T</tt>.
+			 */
+			template <typename T>
+			void construct_integer(Suite &suite, const std::string &case_name) {
+				for (Distribution dist : distributions) {
+					if (!suite.enabled(case_name, name(dist))) continue;
+					Random random = suite.random(case_name, name(dist));
+					std::vector<T> values;
+					for (std::size_t i = 0; i < suite.size(); ++i) values.push_back(static_cast<T>(random.integer(dist)));
+					suite.run(case_name, name(dist), values.size(), [&]() {
+						unsigned long long sum = 0;
+						for (std::size_t i = 0; i < values.size(); ++i) sum += checksum(Fraction(values[i]));
+						return sum;
+					});
+				}
+			}
+
+			/**
+			 * Times the constructor from <tt>T</tt>, fed with <tt>random.floating()</tt>.
+			 */
+			template <typename T>
+			void construct_floating(Suite &suite, const std::string &case_name) {
+				for (Distribution dist : distributions) {
+					if (!suite.enabled(case_name, name(dist))) continue;
+					Random random = suite.random(case_name, name(dist));
+					std::vector<T> values;
+					for (std::size_t i = 0; i < suite.size(); ++i) values.push_back(static_cast<T>(random.floating(dist)));
+					suite.run(case_name, name(dist), values.size(), [&]() {
+						unsigned long long sum = 0;
+						for (std::size_t i = 0; i < values.size(); ++i) sum += checksum(Fraction(values[i]));
+						return sum;
+					});
+				}
+			}
+
+			void construction(Suite &suite) {
+				for (Distribution dist : distributions) {
+					if (!suite.enabled("construct.num_den", name(dist))) continue;
+					Random random = suite.random("construct.num_den", name(dist));
+					std::vector<long long signed int> num, den;
+					for (std::size_t i = 0; i < suite.size(); ++i) {
+						num.push_back(random.integer(dist));
+						den.push_back(random.positive(dist));
+					}
+					suite.run("construct.num_den", name(dist), num.size(), [&]() {
+						unsigned long long sum = 0;
+						for (std::size_t i = 0; i < num.size(); ++i) sum += checksum(Fraction(num[i], den[i]));
+						return sum;
+					});
+				}
+				construct_integer<long long signed int>(suite, "construct.long_long");
+				construct_integer<unsigned long long int>(suite, "construct.unsigned_long_long");
+				construct_integer<long int>(suite, "construct.long");
+				construct_integer<unsigned long int>(suite, "construct.unsigned_long");
+				construct_integer<int>(suite, "construct.int");
+				construct_integer<unsigned int>(suite, "construct.unsigned_int");
+				construct_integer<short>(suite, "construct.short");
+				construct_integer<unsigned short>(suite, "construct.unsigned_short");
+				construct_floating<float>(suite, "construct.float");
+				construct_floating<double>(suite, "construct.double");
+				construct_floating<long double>(suite, "construct.long_double");
+				for (Distribution dist : distributions) {
+					Random random = suite.random("construct.string", name(dist));
+					std::vector<std::string> strings;
+					for (std::size_t i = 0; i < suite.size(); ++i) strings.push_back(random.decimal(dist));
+					suite.run("construct.string", name(dist), strings.size(), [&]() {
+						unsigned long long sum = 0;
+						for (std::size_t i = 0; i < strings.size(); ++i) sum += checksum(Fraction(strings[i]));
+						return sum;
+					});
+					suite.run("construct.c_str", name(dist), strings.size(), [&]() {
+						unsigned long long sum = 0;
+						for (std::size_t i = 0; i < strings.size(); ++i) sum += checksum(Fraction(strings[i].c_str()));
+						return sum;
+					});
+				}
+			}
+
+			void arithmetic(Suite &suite) {
+				binary(suite, "op.add", [](const Fraction &a, const Fraction &b) {return a + b;});
+				binary(suite, "op.sub", [](const Fraction &a, const Fraction &b) {return a - b;});
+				binary(suite, "op.mul", [](const Fraction &a, const Fraction &b) {return a * b;});
+				binary(suite, "op.div", [](const Fraction &a, const Fraction &b) {return a / b;});
+				binary(suite, "op.add_assign", [](const Fraction &a, const Fraction &b) {Fraction x = a; return x += b;});
+				binary(suite, "op.sub_assign", [](const Fraction &a, const Fraction &b) {Fraction x = a; return x -= b;});
+				binary(suite, "op.mul_assign", [](const Fraction &a, const Fraction &b) {Fraction x = a; return x *= b;});
+				binary(suite, "op.div_assign", [](const Fraction &a, const Fraction &b) {Fraction x = a; return x /= b;});
+				unary(suite, "op.negate", [](const Fraction &a) {return -a;});
+				unary(suite, "op.increment", [](const Fraction &a) {Fraction x = a; return ++x;});
+				unary(suite, "op.decrement", [](const Fraction &a) {Fraction x = a; return --x;});
+				unary(suite, "op.post_increment", [](const Fraction &a) {Fraction x = a; x++; return x;});
+				unary(suite, "op.invert", [](const Fraction &a) {return a.invert();});
+				for (Distribution dist : distributions) {
+					if (!suite.enabled("op.pow", name(dist))) continue;
+					Random random = suite.random("op.pow", name(dist));
+					std::vector<Fraction> a;
+					std::vector<int> exponents;
+					for (std::size_t i = 0; i < suite.size(); ++i) {
+						a.push_back(random.fraction(dist));
+						exponents.push_back(static_cast<int>(random.range(-6, 6)));
+					}
+					suite.run("op.pow", name(dist), a.size(), [&]() {
+						unsigned long long sum = 0;
+						for (std::size_t i = 0; i < a.size(); ++i) {
+							Fraction x = a[i];
+							sum += checksum(x.pow(exponents[i]));
+						}
+						return sum;
+					});
+				}
+			}
+
+			void comparison(Suite &suite) {
+				binary(suite, "cmp.eq", [](const Fraction &a, const Fraction &b) {return a == b;});
+				binary(suite, "cmp.ne", [](const Fraction &a, const Fraction &b) {return a != b;});
+				binary(suite, "cmp.lt", [](const Fraction &a, const Fraction &b) {return a <  b;});
+				binary(suite, "cmp.gt", [](const Fraction &a, const Fraction &b) {return a >  b;});
+				binary(suite, "cmp.le", [](const Fraction &a, const Fraction &b) {return a <= b;});
+				binary(suite, "cmp.ge", [](const Fraction &a, const Fraction &b) {return a >= b;});
+				binary(suite, "cmp.compare", [](const Fraction &a, const Fraction &b) {
+					return static_cast<long long signed int>(a.compare(b));
+				});
+				binary(suite, "cmp.compare_double", [](const Fraction &a, const Fraction &b) {
+					return static_cast<long long signed int>(a.compare(b.to_double()));
+				});
+				for (Distribution dist : distributions) {
+					if (!suite.enabled("cmp.compare_double.batch", name(dist))) continue;
+					Random random = suite.random("cmp.compare_double.batch", name(dist));
+					std::vector<Fraction> a;
+					for (std::size_t i = 0; i < suite.size(); ++i) a.push_back(random.fraction(dist));
+					double pivot = random.fraction(dist).to_double();
+					std::vector<signed char> out(a.size());
+					suite.run("cmp.compare_double.batch", name(dist), a.size(), [&]() {
+						Fraction::compare(a.data(), a.size(), pivot, out.data());
+						unsigned long long sum = 0;
+						for (signed char c : out) sum += static_cast<unsigned long long>(c + 1);
+						return sum;
+					});
+				}
+			}
+
+			void conversion(Suite &suite) {
+				unary(suite, "convert.str",   [](const Fraction &a) {return a.str();});
+				unary(suite, "convert.f_str", [](const Fraction &a) {return a.f_str();});
+				unary(suite, "convert.double", [](const Fraction &a) {return a.to_double();});
+				unary(suite, "convert.double_upward", [](const Fraction &a) {return a.to_double(RoundingMode::upward);});
+				unary(suite, "convert.float", [](const Fraction &a) {return static_cast<double>(static_cast<float>(a));});
+				unary(suite, "convert.long_long", [](const Fraction &a) {return static_cast<long long signed int>(a);});
+				for (Distribution dist : distributions) {
+					if (!suite.enabled("convert.double.batch", name(dist))) continue;
+					Random random = suite.random("convert.double.batch", name(dist));
+					std::vector<Fraction> a;
+					for (std::size_t i = 0; i < suite.size(); ++i) a.push_back(random.fraction(dist));
+					std::vector<double> out(a.size());
+					suite.run("convert.double.batch", name(dist), a.size(), [&]() {
+						Fraction::to_double(a.data(), out.data(), a.size());
+						double sum = 0;
+						for (double x : out) sum += x;
+						return checksum(sum);
+					});
+				}
+			}
+
+			/**
+			 * Operators with a built-in operand on either side.
+			 */
+			void mixed(Suite &suite) {
+				binary(suite, "mixed.add_int", [](const Fraction &a, const Fraction &b) {
+					return a + static_cast<int>(b.num());
+				});
+				binary(suite, "mixed.int_add", [](const Fraction &a, const Fraction &b) {
+					return static_cast<int>(b.num()) + a;
+				});
+				binary(suite, "mixed.mul_long_long", [](const Fraction &a, const Fraction &b) {
+					return a * static_cast<long long int>(b.num());
+				});
+				binary(suite, "mixed.div_unsigned", [](const Fraction &a, const Fraction &b) {
+					return a / static_cast<unsigned int>(b.den());
+				});
+				binary(suite, "mixed.add_double", [](const Fraction &a, const Fraction &b) {
+					return a + static_cast<double>(b.num() % 1000) / 8;
+				});
+				binary(suite, "mixed.double_mul", [](const Fraction &a, const Fraction &b) {
+					return static_cast<double>(b.num() % 1000) / 8 * a;
+				});
+				binary(suite, "mixed.eq_int", [](const Fraction &a, const Fraction &b) {
+					return a == static_cast<int>(b.num());
+				});
+				binary(suite, "mixed.lt_double", [](const Fraction &a, const Fraction &b) {
+					return a < b.to_double();
+				});
+				binary(suite, "mixed.double_lt", [](const Fraction &a, const Fraction &b) {
+					return b.to_double() < a;
+				});
+			}
+		}
+
+		void fraction_benchmarks(Suite &suite) {
+			construction(suite);
+			arithmetic(suite);
+			comparison(suite);
+			conversion(suite);
+			mixed(suite);
+		}
+	}
+}
+
+namespace {
+	void usage(const char* program) {
+		std::cerr << "usage: " << program << " [--seed N] [--filter TEXT] [--size N] [--min-time MS] [--output FILE]\n"
+		          << "  --seed N       seed of the input distributions (default 1)\n"
+		          << "  --filter TEXT  only run cases whose case/distribution name contains TEXT\n"
+		          << "  --size N       inputs per case (default 1024)\n"
+		          << "  --min-time MS  minimum time per case in milliseconds (default 50)\n"
+		          << "  --output FILE  write the JSON report to FILE instead of stdout\n";
+	}
+}
+
+int main(int argc, char** argv) {
+	unsigned long long seed = 1;
+	std::string filter, output;
+	std::size_t size = 1024;
+	double min_time = 50;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--help") {
+			usage(argv[0]);
+			return 0;
+		}
+		if (i + 1 >= argc || arg.compare(0, 2, "--") != 0) {
+			usage(argv[0]);
+			return 1;
+		}
+		const char* value = argv[++i];
+		if      (arg == "--seed")     seed = std::strtoull(value, nullptr, 10);
+		else if (arg == "--filter")   filter = value;
+		else if (arg == "--size")     size = std::strtoul(value, nullptr, 10);
+		else if (arg == "--min-time") min_time = std::strtod(value, nullptr);
+		else if (arg == "--output")   output = value;
+		else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	npasson::bench::Suite suite(seed, filter, size, min_time);
+	npasson::bench::fraction_benchmarks(suite);
+	npasson::bench::component_benchmarks(suite);
+
+	if (output.empty()) {
+		suite.write_json(std::cout);
+	} else {
+		std::ofstream file(output);
+		if (!file) {
+			std::cerr << "cannot write " << output << "\n";
+			return 1;
+		}
+		suite.write_json(file);
+	}
+	return 0;
+}
@@ -0,0 +1,273 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file atomic_fraction.cpp
+ * The code of the AtomicFraction and ShardedFractionAccumulator classes.
+ */
+
+#include <cstdint>
+#include <new>
+
+#ifndef NPASSON_EXPERIMENTAL_COMPILE
+	#include "atomic_fraction.hpp"
+#endif
+
+#include "fraction_expression.hpp"
+
+namespace npasson {
+
+#if defined(NPASSON_HAS_CAS16) && defined(__x86_64__)
+	namespace detail {
+
+		/**
+		 * If aligned 16 byte SSE loads are atomic, which Intel and AMD guarantee on processors with AVX. Set during
+		 * static initialization; AtomicFractions loaded before that fall back to the compare-and-swap.
+		 */
+		bool atomic_sse_loads = false;
+
+		struct AtomicSseLoadsDetector {
+			AtomicSseLoadsDetector() {
+				// may run before the constructor of libgcc that otherwise initializes the cpu model
+				__builtin_cpu_init();
+				atomic_sse_loads = __builtin_cpu_supports("avx");
+			}
+		};
+		const AtomicSseLoadsDetector atomic_sse_loads_detector;
+	}
+#endif
+
+	/* === AtomicFraction === */
+
+	AtomicFraction::AtomicFraction() : parts{0, 1} {}
+
+	AtomicFraction::AtomicFraction(const Fraction &frac) : parts(to_parts(frac)) {}
+
+	AtomicFraction::Parts AtomicFraction::to_parts(const Fraction &frac) {
+		if (!frac.valid()) return {0, 0};
+		// invert(Fraction&) may leave a negative denominator behind
+		if (frac.den() < 0) return {-frac.num(), -frac.den()};
+		return {frac.num(), frac.den()};
+	}
+
+	Fraction AtomicFraction::to_fraction(const Parts &parts) {
+		if (parts.den == 0) return INVALID_FRACTION;
+		return Fraction(parts.num, parts.den);
+	}
+
+#ifdef NPASSON_HAS_CAS16
+	/**
+	 * Reads both parts at once, by a single 16 byte load where that is atomic. Otherwise a compare-and-swap of zero
+	 * by zero changes nothing but returns the current value.
+	 */
+	AtomicFraction::Parts AtomicFraction::load_parts() const {
+		unsigned __int128 *word = reinterpret_cast<unsigned __int128*>(&parts);
+		unsigned __int128 value;
+#if defined(__x86_64__)
+		if (detail::atomic_sse_loads) {
+			// x86 loads are acquire loads; the asm keeps the compiler from splitting or reordering it
+			__attribute__((vector_size(16))) long long int vector;
+			__asm__ __volatile__("movdqa %1, %0" : "=x"(vector) : "m"(*word) : "memory");
+			__builtin_memcpy(&value, &vector, sizeof(value));
+		} else
+#endif
+		value = __sync_val_compare_and_swap(word, 0, 0);
+		Parts result;
+		__builtin_memcpy(&result, &value, sizeof(result));
+		return result;
+	}
+
+	/**
+	 * Replaces the parts with <tt>desired</tt> if they still equal <tt>expected</tt>, otherwise loads them into
+	 * <tt>expected</tt>.
+	 *
+	 * @return If the parts were replaced.
+	 */
+	bool AtomicFraction::compare_exchange_parts(Parts &expected, const Parts &desired) {
+		unsigned __int128 *word = reinterpret_cast<unsigned __int128*>(&parts);
+		unsigned __int128 old_value, new_value;
+		__builtin_memcpy(&old_value, &expected, sizeof(old_value));
+		__builtin_memcpy(&new_value, &desired, sizeof(new_value));
+		unsigned __int128 seen = __sync_val_compare_and_swap(word, old_value, new_value);
+		if (seen == old_value) return true;
+		__builtin_memcpy(&expected, &seen, sizeof(expected));
+		return false;
+	}
+
+	bool AtomicFraction::is_lock_free() const {return true;}
+#else
+	AtomicFraction::Parts AtomicFraction::load_parts() const {
+		while (lock.test_and_set(std::memory_order_acquire)) {}
+		Parts result = parts;
+		lock.clear(std::memory_order_release);
+		return result;
+	}
+
+	bool AtomicFraction::compare_exchange_parts(Parts &expected, const Parts &desired) {
+		while (lock.test_and_set(std::memory_order_acquire)) {}
+		bool equal = parts.num == expected.num && parts.den == expected.den;
+		if (equal) parts = desired;
+		else expected = parts;
+		lock.clear(std::memory_order_release);
+		return equal;
+	}
+
+	bool AtomicFraction::is_lock_free() const {return false;}
+#endif
+
+	/**
+	 * @return The current value.
+	 */
+	Fraction AtomicFraction::load() const {
+		return to_fraction(load_parts());
+	}
+
+	/**
+	 * @param frac The new value.
+	 */
+	void AtomicFraction::store(const Fraction &frac) {
+		exchange(frac);
+	}
+
+	/**
+	 * @param frac The new value.
+	 * @return The value before.
+	 */
+	Fraction AtomicFraction::exchange(const Fraction &frac) {
+		Parts desired = to_parts(frac);
+		Parts expected = load_parts();
+		while (!compare_exchange_parts(expected, desired)) {}
+		return to_fraction(expected);
+	}
+
+	/**
+	 * \brief Replaces the value with <tt>desired</tt> if it equals <tt>expected</tt>.
+	 *
+	 * Both are compared in their reduced form, so any representation of the same number matches.
+	 *
+	 * @param expected The value to compare against; receives the current value on failure.
+	 * @param desired The new value.
+	 * @return If the value was replaced.
+	 */
+	bool AtomicFraction::compare_exchange(Fraction &expected, const Fraction &desired) {
+		Parts old_parts = to_parts(expected.valid() ? Fraction(expected.num(), expected.den()) : expected);
+		if (compare_exchange_parts(old_parts, to_parts(desired))) return true;
+		expected = to_fraction(old_parts);
+		return false;
+	}
+
+	/**
+	 * \brief Adds <tt>frac</tt> atomically.
+	 *
+	 * @param frac The summand.
+	 * @return The value before the addition.
+	 */
+	Fraction AtomicFraction::fetch_add(const Fraction &frac) {
+		Parts expected = load_parts();
+		Parts desired;
+		do {
+			desired = to_parts((lazy(to_fraction(expected)) + frac).eval());
+		} while (!compare_exchange_parts(expected, desired));
+		return to_fraction(expected);
+	}
+
+	/**
+	 * \brief Subtracts <tt>frac</tt> atomically.
+	 *
+	 * @param frac The subtrahend.
+	 * @return The value before the subtraction.
+	 */
+	Fraction AtomicFraction::fetch_sub(const Fraction &frac) {
+		Parts expected = load_parts();
+		Parts desired;
+		do {
+			desired = to_parts((lazy(to_fraction(expected)) - frac).eval());
+		} while (!compare_exchange_parts(expected, desired));
+		return to_fraction(expected);
+	}
+
+	/* === ShardedFractionAccumulator === */
+
+	/**
+	 * @param count The number of shards, ideally at least the number of threads adding concurrently.
+	 */
+	ShardedFractionAccumulator::ShardedFractionAccumulator(std::size_t count)
+		: shard_count(count ? count : 1), storage(new unsigned char[(count ? count : 1) * sizeof(Shard) + alignof(Shard)]) {
+		std::uintptr_t address = reinterpret_cast<std::uintptr_t>(storage.get());
+		address = (address + alignof(Shard) - 1) / alignof(Shard) * alignof(Shard);
+		shards = reinterpret_cast<Shard*>(address);
+		for (std::size_t i = 0; i < shard_count; ++i) {
+			new (&shards[i]) Shard();
+		}
+	}
+
+	ShardedFractionAccumulator::~ShardedFractionAccumulator() {
+		for (std::size_t i = 0; i < shard_count; ++i) {
+			shards[i].~Shard();
+		}
+	}
+
+	/**
+	 * Returns the shard of the calling thread. Threads are numbered in the order they first add to any
+	 * accumulator and take the shards round robin.
+	 */
+	ShardedFractionAccumulator::Shard& ShardedFractionAccumulator::local_shard() {
+		static std::atomic<std::size_t> next_thread(0);
+		thread_local std::size_t thread_index = next_thread.fetch_add(1, std::memory_order_relaxed);
+		return shards[thread_index % shard_count];
+	}
+
+	/**
+	 * @param frac The summand.
+	 */
+	void ShardedFractionAccumulator::add(const Fraction &frac) {
+		local_shard().value.fetch_add(frac);
+	}
+
+	/**
+	 * @param frac The subtrahend.
+	 */
+	void ShardedFractionAccumulator::sub(const Fraction &frac) {
+		local_shard().value.fetch_sub(frac);
+	}
+
+	/**
+	 * Merges all shards.
+	 *
+	 * @return The sum of everything added so far.
+	 */
+	Fraction ShardedFractionAccumulator::load() const {
+		Fraction sum;
+		for (std::size_t i = 0; i < shard_count; ++i) {
+			sum = (lazy(sum) + shards[i].value.load()).eval();
+		}
+		return sum;
+	}
+
+	/**
+	 * Sets the sum back to zero. Not atomic with respect to concurrent additions.
+	 */
+	void ShardedFractionAccumulator::reset() {
+		for (std::size_t i = 0; i < shard_count; ++i) {
+			shards[i].value.store(Fraction());
+		}
+	}
+}
@@ -0,0 +1,132 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file atomic_fraction.hpp
+ * Contains AtomicFraction, a lock-free shared Fraction, and ShardedFractionAccumulator for contended sums.
+ */
+
+#ifndef NPASSON_ATOMIC_FRACTION_HPP
+#define NPASSON_ATOMIC_FRACTION_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "fraction.hpp"
+
+// cmpxchg16b is only emitted inline with -mcx16 (or a -march that implies it); without it AtomicFraction falls
+// back to a spinlock rather than pulling in libatomic
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+#define NPASSON_HAS_CAS16 1
+#endif
+
+namespace npasson {
+
+	/**
+	 * \brief A Fraction that can be read and updated concurrently without a mutex.
+	 *
+	 * The reduced numerator and denominator are kept in one 16 byte word that is replaced as a whole by a 128 bit
+	 * compare-and-swap, so readers never see half an update. Read-modify-write operations are compare-and-swap
+	 * loops around the usual Fraction arithmetic, with overflows yielding an invalid Fraction like
+	 * <tt>lazy()</tt> expressions do. An invalid value is stored as a zero denominator.
+	 *
+	 * On x86-64 processors with AVX, which guarantee aligned 16 byte SSE loads to be atomic, <tt>load()</tt> is a
+	 * single such load and readers never write to the contended cache line. Elsewhere it is a compare-and-swap
+	 * that writes back the value it read.
+	 *
+	 * Without 16 byte compare-and-swap (compile with <tt>-mcx16</tt> on x86-64) every operation takes a spinlock
+	 * instead; <tt>is_lock_free()</tt> tells which one is in use. The layout is the same either way, so translation
+	 * units compiled with and without <tt>-mcx16</tt> agree on it.
+	 */
+	class AtomicFraction {
+
+	private:
+		struct alignas(16) Parts {
+			long long signed int num;
+			long long signed int den;
+		};
+
+		mutable Parts parts;
+		mutable std::atomic_flag lock = ATOMIC_FLAG_INIT; // only taken without 16 byte compare-and-swap
+
+		static Parts    to_parts(const Fraction&);
+		static Fraction to_fraction(const Parts&);
+
+		Parts load_parts() const;
+		bool  compare_exchange_parts(Parts&, const Parts&);
+
+	public:
+		AtomicFraction();
+		explicit AtomicFraction(const Fraction&);
+		AtomicFraction(const AtomicFraction&) = delete;
+		AtomicFraction& operator=(const AtomicFraction&) = delete;
+
+		Fraction load() const;
+		void     store(const Fraction&);
+		Fraction exchange(const Fraction&);
+		bool     compare_exchange(Fraction&, const Fraction&);
+
+		Fraction fetch_add(const Fraction&);
+		Fraction fetch_sub(const Fraction&);
+
+		operator Fraction() const {return load();} // NOLINT
+		bool is_lock_free() const;
+	};
+
+	/**
+	 * \brief A sum that many threads add to, spread over several AtomicFractions.
+	 *
+	 * Each thread adds into its own shard, one cache line each, so concurrent additions rarely touch the same
+	 * word. The shards are only merged when the total is read, which makes reads cost one load and addition per
+	 * shard and makes them approximate while additions are still running.
+	 */
+	class ShardedFractionAccumulator {
+
+	private:
+		struct alignas(64) Shard {
+			AtomicFraction value;
+		};
+
+		std::size_t shard_count;
+		std::unique_ptr<unsigned char[]> storage; // over-allocated, since new only aligns to 64 bytes from C++17 on
+		Shard* shards;
+
+		Shard& local_shard();
+
+	public:
+		explicit ShardedFractionAccumulator(std::size_t count = 64);
+		~ShardedFractionAccumulator();
+		ShardedFractionAccumulator(const ShardedFractionAccumulator&) = delete;
+		ShardedFractionAccumulator& operator=(const ShardedFractionAccumulator&) = delete;
+
+		void     add(const Fraction&);
+		void     sub(const Fraction&);
+		Fraction load() const;
+		void     reset();
+	};
+}
+
+#ifdef NPASSON_EXPERIMENTAL_COMPILE
+#include "atomic_fraction.cpp"
+#endif
+
+#endif //NPASSON_ATOMIC_FRACTION_HPP
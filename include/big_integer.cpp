@@ -0,0 +1,371 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file big_integer.cpp
+ * The code of the BigInteger class.
+ */
+
+#include <algorithm>
+
+#ifndef NPASSON_EXPERIMENTAL_COMPILE
+	#include "big_integer.hpp"
+#endif
+
+namespace npasson {
+
+	BigInteger::BigInteger(long long signed int value) {
+		negative = value < 0;
+		// negate in unsigned so that the most negative value survives
+		unsigned long long int magnitude = negative ? 0ull - static_cast<unsigned long long int>(value)
+		                                            : static_cast<unsigned long long int>(value);
+		while (magnitude) {
+			limbs.push_back(static_cast<std::uint32_t>(magnitude));
+			magnitude >>= 32;
+		}
+	}
+
+	/**
+	 * Removes leading zero limbs and clears the sign of zero.
+	 */
+	void BigInteger::trim() {
+		while (!limbs.empty() && limbs.back() == 0) limbs.pop_back();
+		if (limbs.empty()) negative = false;
+	}
+
+	/**
+	 * @return <tt>-1</tt>, <tt>0</tt> or <tt>1</tt> if <tt>a</tt> is less than, equal to or greater than <tt>b</tt>.
+	 */
+	int BigInteger::compare_magnitude(const std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b) {
+		if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+		for (std::size_t i = a.size(); i-- > 0; ) {
+			if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+		}
+		return 0;
+	}
+
+	/**
+	 * <tt>a += b</tt> on magnitudes.
+	 */
+	void BigInteger::add_magnitude(std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b) {
+		if (a.size() < b.size()) a.resize(b.size(), 0);
+		std::uint64_t carry = 0;
+		for (std::size_t i = 0; i < a.size(); ++i) {
+			std::uint64_t sum = carry + a[i] + (i < b.size() ? b[i] : 0);
+			a[i] = static_cast<std::uint32_t>(sum);
+			carry = sum >> 32;
+			if (!carry && i >= b.size()) break;
+		}
+		if (carry) a.push_back(static_cast<std::uint32_t>(carry));
+	}
+
+	/**
+	 * <tt>a -= b</tt> on magnitudes, requires <tt>a >= b</tt>.
+	 */
+	void BigInteger::sub_magnitude(std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b) {
+		std::int64_t borrow = 0;
+		for (std::size_t i = 0; i < a.size(); ++i) {
+			std::int64_t diff = static_cast<std::int64_t>(a[i]) - (i < b.size() ? b[i] : 0) - borrow;
+			borrow = diff < 0 ? 1 : 0;
+			a[i] = static_cast<std::uint32_t>(diff + (borrow << 32));
+			if (!borrow && i >= b.size()) break;
+		}
+	}
+
+	/**
+	 * \brief Long division on magnitudes, requires <tt>b</tt> to be nonzero.
+	 *
+	 * Knuth's algorithm D: the divisor is shifted until its top limb has the high bit set, so that the quotient
+	 * digit estimated from the top two limbs is at most two too large.
+	 */
+	void BigInteger::divide_magnitude(const std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b,
+	                                  std::vector<std::uint32_t> &quotient, std::vector<std::uint32_t> &remainder) {
+		if (compare_magnitude(a, b) < 0) {
+			quotient.clear();
+			remainder = a;
+			return;
+		}
+		if (b.size() == 1) {
+			quotient.assign(a.size(), 0);
+			std::uint64_t rest = 0;
+			for (std::size_t i = a.size(); i-- > 0; ) {
+				std::uint64_t current = (rest << 32) | a[i];
+				quotient[i] = static_cast<std::uint32_t>(current / b[0]);
+				rest = current % b[0];
+			}
+			while (!quotient.empty() && quotient.back() == 0) quotient.pop_back();
+			remainder.clear();
+			if (rest) remainder.push_back(static_cast<std::uint32_t>(rest));
+			return;
+		}
+
+		int shift = 0;
+		while (!(b.back() & (0x80000000u >> shift))) ++shift;
+		const std::size_t n = b.size();
+		std::vector<std::uint32_t> v(n);
+		std::vector<std::uint32_t> u(a.size() + 1);
+		for (std::size_t i = n; i-- > 0; ) {
+			v[i] = (b[i] << shift) | ((shift && i > 0) ? (b[i - 1] >> (32 - shift)) : 0);
+		}
+		u[a.size()] = shift ? (a.back() >> (32 - shift)) : 0;
+		for (std::size_t i = a.size(); i-- > 0; ) {
+			u[i] = (a[i] << shift) | ((shift && i > 0) ? (a[i - 1] >> (32 - shift)) : 0);
+		}
+
+		const std::uint64_t base = 1ull << 32;
+		quotient.assign(a.size() - n + 1, 0);
+		for (std::size_t j = a.size() - n + 1; j-- > 0; ) {
+			std::uint64_t top = (static_cast<std::uint64_t>(u[j + n]) << 32) | u[j + n - 1];
+			std::uint64_t estimate = top / v[n - 1];
+			std::uint64_t rest = top % v[n - 1];
+			while (estimate >= base || estimate * v[n - 2] > ((rest << 32) | u[j + n - 2])) {
+				--estimate;
+				rest += v[n - 1];
+				if (rest >= base) break;
+			}
+
+			std::int64_t borrow = 0;
+			std::uint64_t carry = 0;
+			for (std::size_t i = 0; i < n; ++i) {
+				std::uint64_t product = estimate * v[i] + carry;
+				carry = product >> 32;
+				std::int64_t diff = static_cast<std::int64_t>(u[i + j]) - borrow - static_cast<std::int64_t>(product & 0xFFFFFFFFu);
+				u[i + j] = static_cast<std::uint32_t>(diff);
+				borrow = diff < 0 ? 1 : 0;
+			}
+			std::int64_t diff = static_cast<std::int64_t>(u[j + n]) - borrow - static_cast<std::int64_t>(carry);
+			u[j + n] = static_cast<std::uint32_t>(diff);
+
+			if (diff < 0) {
+				// the estimate was one too large, add the divisor back
+				--estimate;
+				std::uint64_t sum_carry = 0;
+				for (std::size_t i = 0; i < n; ++i) {
+					std::uint64_t sum = static_cast<std::uint64_t>(u[i + j]) + v[i] + sum_carry;
+					u[i + j] = static_cast<std::uint32_t>(sum);
+					sum_carry = sum >> 32;
+				}
+				u[j + n] += static_cast<std::uint32_t>(sum_carry);
+			}
+			quotient[j] = static_cast<std::uint32_t>(estimate);
+		}
+		while (!quotient.empty() && quotient.back() == 0) quotient.pop_back();
+
+		remainder.assign(n, 0);
+		for (std::size_t i = 0; i < n; ++i) {
+			remainder[i] = (u[i] >> shift) | (shift ? (u[i + 1] << (32 - shift)) : 0);
+		}
+		while (!remainder.empty() && remainder.back() == 0) remainder.pop_back();
+	}
+
+	/**
+	 * @return <tt>-1</tt>, <tt>0</tt> or <tt>1</tt> for negative, zero or positive values.
+	 */
+	int BigInteger::sign() const {
+		return limbs.empty() ? 0 : (negative ? -1 : 1);
+	}
+
+	/**
+	 * @return The number of bits of the magnitude, <tt>0</tt> for zero.
+	 */
+	std::size_t BigInteger::bit_length() const {
+		if (limbs.empty()) return 0;
+		std::size_t bits = 32 * (limbs.size() - 1);
+		for (std::uint32_t top = limbs.back(); top != 0; top >>= 1) ++bits;
+		return bits;
+	}
+
+	/**
+	 * @param rhs The BigInteger to compare against.
+	 * @return <tt>-1</tt>, <tt>0</tt> or <tt>1</tt> if <tt>this</tt> is less than, equal to or greater than <tt>rhs</tt>.
+	 */
+	int BigInteger::compare(const BigInteger &rhs) const {
+		if (negative != rhs.negative) return negative ? -1 : 1;
+		int magnitude = compare_magnitude(limbs, rhs.limbs);
+		return negative ? -magnitude : magnitude;
+	}
+
+	/**
+	 * Stores the value in <tt>out</tt> if it fits into a <tt>long long signed int</tt>.
+	 *
+	 * @return <tt>false</tt>, leaving <tt>out</tt> alone, if it does not fit.
+	 */
+	bool BigInteger::to_long_long(long long signed int &out) const {
+		if (limbs.size() > 2) return false;
+		unsigned long long int magnitude = 0;
+		for (std::size_t i = limbs.size(); i-- > 0; ) magnitude = (magnitude << 32) | limbs[i];
+		if (magnitude > (negative ? 9223372036854775808ull : 9223372036854775807ull)) return false;
+		out = negative ? static_cast<long long signed int>(0ull - magnitude) : static_cast<long long signed int>(magnitude);
+		return true;
+	}
+
+	/**
+	 * @return The nearest <tt>double</tt>, up to the last bit, or infinity beyond its range.
+	 */
+	double BigInteger::to_double() const {
+		double result = 0;
+		for (std::size_t i = limbs.size(); i-- > 0; ) result = result * 4294967296.0 + limbs[i];
+		return negative ? -result : result;
+	}
+
+	/**
+	 * \brief Truncating division, like the built-in integers.
+	 *
+	 * The quotient is rounded toward zero and the remainder takes the sign of the dividend. The divisor must not
+	 * be zero.
+	 *
+	 * @param a The dividend.
+	 * @param b The divisor.
+	 * @param quotient Receives <tt>a / b</tt>.
+	 * @param remainder Receives <tt>a % b</tt>.
+	 */
+	void BigInteger::divide(const BigInteger &a, const BigInteger &b, BigInteger &quotient, BigInteger &remainder) {
+		bool quotient_negative = a.negative != b.negative;
+		bool remainder_negative = a.negative;
+		std::vector<std::uint32_t> q, r;
+		divide_magnitude(a.limbs, b.limbs, q, r);
+		quotient.limbs.swap(q);
+		quotient.negative = quotient_negative;
+		quotient.trim();
+		remainder.limbs.swap(r);
+		remainder.negative = remainder_negative;
+		remainder.trim();
+	}
+
+	/**
+	 * @return <tt>floor(a / b)</tt>, for a nonzero <tt>b</tt>.
+	 */
+	BigInteger BigInteger::floor_divide(const BigInteger &a, const BigInteger &b) {
+		BigInteger quotient, remainder;
+		divide(a, b, quotient, remainder);
+		if (!remainder.is_zero() && (remainder.negative != b.negative)) quotient -= 1;
+		return quotient;
+	}
+
+	/**
+	 * Returns the decimal representation. Quadratic in the length, meant for debugging and output only.
+	 *
+	 * @return <tt>this</tt> as a <tt>std::string</tt>.
+	 */
+	std::string BigInteger::str() const {
+		if (limbs.empty()) return "0";
+		std::vector<std::uint32_t> rest(limbs);
+		std::string digits;
+		while (!rest.empty()) {
+			// divide by 10^9 and emit the remainder as nine digits
+			std::uint64_t remainder = 0;
+			for (std::size_t i = rest.size(); i-- > 0; ) {
+				std::uint64_t current = (remainder << 32) | rest[i];
+				rest[i] = static_cast<std::uint32_t>(current / 1000000000u);
+				remainder = current % 1000000000u;
+			}
+			while (!rest.empty() && rest.back() == 0) rest.pop_back();
+			for (int i = 0; i < 9 && (remainder || !rest.empty()); ++i) {
+				digits.push_back(static_cast<char>('0' + remainder % 10));
+				remainder /= 10;
+			}
+		}
+		if (negative) digits.push_back('-');
+		std::reverse(digits.begin(), digits.end());
+		return digits;
+	}
+
+	/* === OPERATORS === */
+
+	BigInteger& BigInteger::operator+=(const BigInteger &rhs) {
+		if (negative == rhs.negative) {
+			add_magnitude(limbs, rhs.limbs);
+		} else if (compare_magnitude(limbs, rhs.limbs) >= 0) {
+			sub_magnitude(limbs, rhs.limbs);
+		} else {
+			std::vector<std::uint32_t> result(rhs.limbs);
+			sub_magnitude(result, limbs);
+			limbs.swap(result);
+			negative = rhs.negative;
+		}
+		trim();
+		return *this;
+	}
+	BigInteger  BigInteger::operator+ (const BigInteger &rhs) const {
+		BigInteger temp = (*this);
+		return temp += rhs;
+	}
+
+	BigInteger& BigInteger::operator-=(const BigInteger &rhs) {
+		return (*this) += -rhs;
+	}
+	BigInteger  BigInteger::operator- (const BigInteger &rhs) const {
+		BigInteger temp = (*this);
+		return temp -= rhs;
+	}
+
+	BigInteger& BigInteger::operator*=(const BigInteger &rhs) {
+		if (limbs.empty() || rhs.limbs.empty()) {
+			limbs.clear();
+			negative = false;
+			return *this;
+		}
+		std::vector<std::uint32_t> result(limbs.size() + rhs.limbs.size(), 0);
+		for (std::size_t i = 0; i < limbs.size(); ++i) {
+			std::uint64_t carry = 0;
+			for (std::size_t j = 0; j < rhs.limbs.size(); ++j) {
+				std::uint64_t current = static_cast<std::uint64_t>(limbs[i]) * rhs.limbs[j] + result[i + j] + carry;
+				result[i + j] = static_cast<std::uint32_t>(current);
+				carry = current >> 32;
+			}
+			result[i + rhs.limbs.size()] = static_cast<std::uint32_t>(carry);
+		}
+		limbs.swap(result);
+		negative = negative != rhs.negative;
+		trim();
+		return *this;
+	}
+	BigInteger  BigInteger::operator* (const BigInteger &rhs) const {
+		BigInteger temp = (*this);
+		return temp *= rhs;
+	}
+
+	BigInteger& BigInteger::operator/=(const BigInteger &rhs) {
+		BigInteger remainder;
+		divide(*this, rhs, *this, remainder);
+		return *this;
+	}
+	BigInteger  BigInteger::operator/ (const BigInteger &rhs) const {
+		BigInteger temp = (*this);
+		return temp /= rhs;
+	}
+
+	BigInteger& BigInteger::operator%=(const BigInteger &rhs) {
+		BigInteger quotient;
+		divide(*this, rhs, quotient, *this);
+		return *this;
+	}
+	BigInteger  BigInteger::operator% (const BigInteger &rhs) const {
+		BigInteger temp = (*this);
+		return temp %= rhs;
+	}
+
+	BigInteger BigInteger::operator- () const {
+		BigInteger temp = (*this);
+		if (!temp.limbs.empty()) temp.negative = !temp.negative;
+		return temp;
+	}
+}
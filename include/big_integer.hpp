@@ -0,0 +1,97 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file big_integer.hpp
+ * Contains the BigInteger type, an arbitrary precision integer for intermediate results that outgrow 64 bits.
+ */
+
+#ifndef NPASSON_BIG_INTEGER_HPP
+#define NPASSON_BIG_INTEGER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace npasson {
+
+	/**
+	 * \brief An arbitrary precision signed integer.
+	 *
+	 * Stored as sign and magnitude, the magnitude in 32 bit limbs with the least significant limb first and no
+	 * leading zero limbs, so zero has no limbs at all. It is meant as the last resort behind the fixed width fast
+	 * paths and therefore only as fast as schoolbook arithmetic gets.
+	 */
+	class BigInteger {
+
+	private:
+		bool negative = false;
+		std::vector<std::uint32_t> limbs;
+
+		void trim();
+		static int  compare_magnitude(const std::vector<std::uint32_t>&, const std::vector<std::uint32_t>&);
+		static void add_magnitude(std::vector<std::uint32_t>&, const std::vector<std::uint32_t>&);
+		static void sub_magnitude(std::vector<std::uint32_t>&, const std::vector<std::uint32_t>&);
+		static void divide_magnitude(const std::vector<std::uint32_t>&, const std::vector<std::uint32_t>&,
+		                             std::vector<std::uint32_t>&, std::vector<std::uint32_t>&);
+
+	public:
+		BigInteger() = default;
+		BigInteger(long long signed int); // NOLINT
+
+		int sign() const;
+		bool is_zero() const {return limbs.empty();}
+		std::size_t bit_length() const;
+		int compare(const BigInteger&) const;
+		bool to_long_long(long long signed int&) const;
+		double to_double() const;
+		std::string str() const;
+
+		static void divide(const BigInteger&, const BigInteger&, BigInteger&, BigInteger&);
+		static BigInteger floor_divide(const BigInteger&, const BigInteger&);
+
+		BigInteger& operator += (const BigInteger&);
+		BigInteger  operator +  (const BigInteger&) const;
+		BigInteger& operator -= (const BigInteger&);
+		BigInteger  operator -  (const BigInteger&) const;
+		BigInteger& operator *= (const BigInteger&);
+		BigInteger  operator *  (const BigInteger&) const;
+		BigInteger& operator /= (const BigInteger&);
+		BigInteger  operator /  (const BigInteger&) const;
+		BigInteger& operator %= (const BigInteger&);
+		BigInteger  operator %  (const BigInteger&) const;
+		BigInteger  operator -  () const;
+
+		bool operator==(const BigInteger &rhs) const {return compare(rhs) == 0;}
+		bool operator!=(const BigInteger &rhs) const {return compare(rhs) != 0;}
+		bool operator< (const BigInteger &rhs) const {return compare(rhs) <  0;}
+		bool operator> (const BigInteger &rhs) const {return compare(rhs) >  0;}
+		bool operator<=(const BigInteger &rhs) const {return compare(rhs) <= 0;}
+		bool operator>=(const BigInteger &rhs) const {return compare(rhs) >= 0;}
+	};
+}
+
+#ifdef NPASSON_EXPERIMENTAL_COMPILE
+#include "big_integer.cpp"
+#endif
+
+#endif //NPASSON_BIG_INTEGER_HPP
@@ -0,0 +1,126 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file checked_arithmetic.hpp
+ * Contains the overflow-checked integer operations shared by the lazily evaluated, fixed point and polynomial
+ * types, and the narrowing of wide intermediates back to 64 bits.
+ */
+
+#ifndef NPASSON_CHECKED_ARITHMETIC_HPP
+#define NPASSON_CHECKED_ARITHMETIC_HPP
+
+namespace npasson {
+
+	namespace detail {
+
+		/**
+		 * The largest magnitude of a checked result. The most negative <tt>long long</tt> has no negation, so the
+		 * checked operations work on the symmetric range and treat it as an overflow, both as result and operand.
+		 */
+		const long long signed int checked_limit = 9223372036854775807ll;
+
+		/**
+		 * Stores <tt>a + b</tt> in <tt>result</tt> if it lies within <tt>±checked_limit</tt>.
+		 *
+		 * @return <tt>false</tt> on overflow, leaving <tt>result</tt> untouched.
+		 */
+		inline bool checked_add(long long signed int a, long long signed int b, long long signed int* result) {
+			if (a < -checked_limit || b < -checked_limit) return false;
+#if defined(__GNUC__) || defined(__clang__)
+			long long signed int sum;
+			if (__builtin_add_overflow(a, b, &sum) || sum < -checked_limit) return false;
+#else
+			if ((b > 0) ? (a > checked_limit - b) : (a < -checked_limit - b)) return false;
+			long long signed int sum = a + b;
+#endif
+			*result = sum;
+			return true;
+		}
+
+		inline bool checked_sub(long long signed int a, long long signed int b, long long signed int* result) {
+			if (b < -checked_limit) return false;
+			return checked_add(a, -b, result);
+		}
+
+		inline bool checked_mul(long long signed int a, long long signed int b, long long signed int* result) {
+			if (a < -checked_limit || b < -checked_limit) return false;
+#if defined(__GNUC__) || defined(__clang__)
+			long long signed int product;
+			if (__builtin_mul_overflow(a, b, &product) || product < -checked_limit) return false;
+#else
+			unsigned long long int x = static_cast<unsigned long long int>((a < 0) ? -a : a);
+			unsigned long long int y = static_cast<unsigned long long int>((b < 0) ? -b : b);
+			if (x != 0 && y > static_cast<unsigned long long int>(checked_limit) / x) return false;
+			long long signed int product = static_cast<long long signed int>(x * y);
+			product = ((a < 0) != (b < 0)) ? -product : product;
+#endif
+			*result = product;
+			return true;
+		}
+
+#if defined(__SIZEOF_INT128__)
+		typedef __int128 wide_int;
+
+		// the full 128 bit range, narrow() checks the symmetric one at the end
+		inline bool checked_add(__int128 a, __int128 b, __int128* result) {return !__builtin_add_overflow(a, b, result);}
+		inline bool checked_sub(__int128 a, __int128 b, __int128* result) {return !__builtin_sub_overflow(a, b, result);}
+		inline bool checked_mul(__int128 a, __int128 b, __int128* result) {return !__builtin_mul_overflow(a, b, result);}
+#else
+		// without 128 bit integers intermediates are as wide as the results and overflow sooner
+		typedef long long signed int wide_int;
+#endif
+
+		/**
+		 * The gcd of <tt>a</tt> and <tt>b > 0</tt>, for any sign of <tt>a</tt>.
+		 */
+		inline wide_int wide_gcd(wide_int a, wide_int b) {
+			wide_int t;
+			while (b != 0) {
+				t = b;
+				b = a % b;
+				a = t;
+			}
+			return (a < 0) ? -a : a;
+		}
+
+		/**
+		 * Reduces a wide intermediate <tt>n/d</tt> with <tt>d > 0</tt> and stores it if it then lies within
+		 * <tt>±checked_limit</tt>.
+		 *
+		 * @return <tt>false</tt> if the reduced value still does not fit, leaving <tt>num</tt> and <tt>den</tt> untouched.
+		 */
+		inline bool narrow(wide_int n, wide_int d, long long signed int &num, long long signed int &den) {
+			wide_int divisor = wide_gcd(n, d);
+			if (divisor > 1) {
+				n /= divisor;
+				d /= divisor;
+			}
+			const wide_int limit = static_cast<wide_int>(checked_limit);
+			if (n > limit || n < -limit || d > limit) return false;
+			num = static_cast<long long signed int>(n);
+			den = static_cast<long long signed int>(d);
+			return true;
+		}
+	}
+}
+
+#endif //NPASSON_CHECKED_ARITHMETIC_HPP
@@ -0,0 +1,648 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file continued_fraction.cpp
+ * The code of the ContinuedFraction class.
+ */
+
+#include <algorithm>
+#include <utility>
+
+#ifndef NPASSON_EXPERIMENTAL_COMPILE
+	#include "continued_fraction.hpp"
+#endif
+
+namespace npasson {
+
+	namespace detail {
+
+		/**
+		 * \brief A source of continued fraction terms that caches what it produced.
+		 */
+		class TermStream {
+
+		private:
+			std::vector<BigInteger> cache;
+			bool finished = false;
+
+		protected:
+			/**
+			 * Produces the next term, or returns <tt>false</tt> if the expansion ends.
+			 */
+			virtual bool next(BigInteger&) = 0;
+
+		public:
+			virtual ~TermStream() = default;
+
+			/**
+			 * Stores the value as <tt>(p + sqrt(d)) / q</tt>, with <tt>d</tt> zero or not a perfect square.
+			 *
+			 * @return <tt>false</tt> if the stream does not know its value in closed form.
+			 */
+			virtual bool closed_form(BigInteger&, BigInteger&, BigInteger&) const {
+				return false;
+			}
+
+			/**
+			 * Stores term <tt>i</tt> in <tt>out</tt>, computing it and all before it if needed.
+			 *
+			 * @return <tt>false</tt> if the expansion ends before term <tt>i</tt>.
+			 */
+			bool term(std::size_t i, BigInteger &out) {
+				while (cache.size() <= i && !finished) {
+					BigInteger value;
+					if (next(value)) cache.push_back(std::move(value));
+					else finished = true;
+				}
+				if (i >= cache.size()) return false;
+				out = cache[i];
+				return true;
+			}
+		};
+
+		/**
+		 * Euclid's algorithm on <tt>p/q</tt>, with <tt>q > 0</tt>.
+		 */
+		class RationalStream : public TermStream {
+
+		private:
+			BigInteger p, q;
+			const BigInteger value_p, value_q;
+
+		protected:
+			bool next(BigInteger &out) override {
+				if (q.is_zero()) return false;
+				out = BigInteger::floor_divide(p, q);
+				BigInteger rest = p - out * q;
+				p = std::move(q);
+				q = std::move(rest);
+				return true;
+			}
+
+		public:
+			RationalStream(BigInteger p, BigInteger q) : p(p), q(q), value_p(std::move(p)), value_q(std::move(q)) {}
+
+			bool closed_form(BigInteger &p_out, BigInteger &d_out, BigInteger &q_out) const override {
+				if (value_q.is_zero()) return false;
+				p_out = value_p;
+				d_out = 0;
+				q_out = value_q;
+				return true;
+			}
+		};
+
+		/**
+		 * \brief The expansion of <tt>(p + sqrt(d)) / q</tt> for a <tt>d</tt> that is not a perfect square.
+		 *
+		 * Every step takes <tt>a = floor((p + sqrt(d)) / q)</tt> and continues with the reciprocal of the rest,
+		 * which is again of that form with <tt>p = a*q - p</tt> and <tt>q = (d - p^2) / q</tt>. The division is
+		 * exact as long as <tt>q</tt> divides <tt>d - p^2</tt>, which the constructor ensures. Since the root is
+		 * irrational, the floor only needs <tt>s = floor(sqrt(d))</tt>.
+		 */
+		class QuadraticStream : public TermStream {
+
+		private:
+			BigInteger p, d, q, s;
+			BigInteger value_p, value_d, value_q;
+
+		protected:
+			bool next(BigInteger &out) override {
+				if (q.sign() > 0) {
+					out = BigInteger::floor_divide(p + s, q);
+				} else {
+					out = -(BigInteger::floor_divide(p + s, -q) + 1);
+				}
+				p = out * q - p;
+				q = (d - p * p) / q;
+				return true;
+			}
+
+		public:
+			QuadraticStream(BigInteger p, BigInteger d, BigInteger q, BigInteger s)
+				: p(std::move(p)), d(std::move(d)), q(std::move(q)), s(std::move(s)) {
+				if (!((this->d - this->p * this->p) % this->q).is_zero()) {
+					// (p + sqrt(d)) / q = (p|q| + sqrt(d q^2)) / (q|q|)
+					BigInteger magnitude = (this->q.sign() < 0) ? -this->q : this->q;
+					this->p *= magnitude;
+					this->d *= this->q * this->q;
+					this->q *= magnitude;
+					this->s = integer_sqrt(this->d);
+				}
+				value_p = this->p;
+				value_d = this->d;
+				value_q = this->q;
+			}
+
+			bool closed_form(BigInteger &p_out, BigInteger &d_out, BigInteger &q_out) const override {
+				p_out = value_p;
+				d_out = value_d;
+				q_out = value_q;
+				return true;
+			}
+
+			/**
+			 * <tt>floor(sqrt(n))</tt> for <tt>n >= 0</tt> by Newton's method, starting above the root.
+			 */
+			static BigInteger integer_sqrt(const BigInteger &n) {
+				if (n.sign() <= 0) return BigInteger(0);
+				BigInteger x = n;
+				BigInteger next = (x + 1) / 2;
+				while (next < x) {
+					x = next;
+					next = (x + n / x) / 2;
+				}
+				return x;
+			}
+		};
+
+		/**
+		 * @return The gcd of <tt>|a|</tt> and <tt>|b|</tt>, <tt>0</tt> if both are zero.
+		 */
+		inline BigInteger continued_fraction_gcd(BigInteger a, BigInteger b) {
+			if (a.sign() < 0) a = -a;
+			if (b.sign() < 0) b = -b;
+			while (!b.is_zero()) {
+				BigInteger rest = a % b;
+				a = std::move(b);
+				b = std::move(rest);
+			}
+			return a;
+		}
+
+		/**
+		 * \brief Gosper's algorithm on <tt>z = (a xy + b x + c y + d) / (e xy + f x + g y + h)</tt>.
+		 *
+		 * <tt>numer</tt> and <tt>denom</tt> hold the coefficients of <tt>xy</tt>, <tt>x</tt>, <tt>y</tt> and 1.
+		 * Once a term has been taken from each input, the rest of each input lies in <tt>[1, inf]</tt>, so
+		 * <tt>z</tt> lies between its values at the four corners of that range unless it has a pole inside. If those
+		 * all have the same integer part <tt>t</tt>, that is the next term, and the state continues with
+		 * <tt>1 / (z - t)</tt>. Otherwise the next term of the input whose range moves <tt>z</tt> more is
+		 * substituted, <tt>x = t + 1/x'</tt>. An input that ends is infinity from then on, after which only
+		 * the ratios at <tt>x = inf</tt> matter.
+		 *
+		 * If <tt>x</tt> and <tt>y</tt> are the same stream, <tt>z</tt> is only ever evaluated at <tt>x = y</tt>.
+		 * Each term then goes into both at once and the coefficients of <tt>y</tt> are folded into those of
+		 * <tt>x</tt>, so that e.g. <tt>x - x</tt> has a zero numerator from the start.
+		 */
+		class GosperStream : public TermStream {
+
+		private:
+			std::shared_ptr<TermStream> x, y;
+			std::size_t x_index = 0, y_index = 0;
+			bool x_done = false, y_done = false;
+			const bool diagonal;
+			BigInteger numer[4], denom[4];
+
+			enum : int {xy = 0, x_only = 1, y_only = 2, constant = 3};
+
+			/**
+			 * On the diagonal, moves the coefficients of <tt>y</tt> onto <tt>x</tt>, which leaves <tt>z</tt>
+			 * unchanged there.
+			 */
+			void fold() {
+				for (BigInteger* v : {numer, denom}) {
+					v[x_only] += v[y_only];
+					v[y_only] = 0;
+				}
+			}
+
+			/**
+			 * @return The bit length of the largest coefficient.
+			 */
+			std::size_t bits() const {
+				std::size_t result = 0;
+				for (const BigInteger* v : {numer, denom}) {
+					for (int i = 0; i < 4; ++i) {
+						if (v[i].bit_length() > result) result = v[i].bit_length();
+					}
+				}
+				return result;
+			}
+
+			/**
+			 * Substitutes the next term of <tt>x</tt>, or <tt>x = inf</tt> if it ended.
+			 *
+			 * @return <tt>false</tt> if <tt>x</tt> has no terms at all.
+			 */
+			bool ingest_x() {
+				BigInteger t;
+				if (!x->term(x_index, t)) {
+					if (x_index == 0) return false;
+					x_done = true;
+					for (BigInteger* v : {numer, denom}) {
+						v[y_only] = v[xy];
+						v[constant] = v[x_only];
+						v[xy] = 0;
+						v[x_only] = 0;
+					}
+					return true;
+				}
+				++x_index;
+				for (BigInteger* v : {numer, denom}) {
+					BigInteger new_xy = v[xy] * t + v[y_only];
+					BigInteger new_x = v[x_only] * t + v[constant];
+					v[y_only] = std::move(v[xy]);
+					v[constant] = std::move(v[x_only]);
+					v[xy] = std::move(new_xy);
+					v[x_only] = std::move(new_x);
+				}
+				return true;
+			}
+
+			/**
+			 * Substitutes the next term of <tt>y</tt>, or <tt>y = inf</tt> if it ended.
+			 *
+			 * @return <tt>false</tt> if <tt>y</tt> has no terms at all.
+			 */
+			bool ingest_y() {
+				BigInteger t;
+				if (!y->term(y_index, t)) {
+					if (y_index == 0) return false;
+					y_done = true;
+					for (BigInteger* v : {numer, denom}) {
+						v[x_only] = v[xy];
+						v[constant] = v[y_only];
+						v[xy] = 0;
+						v[y_only] = 0;
+					}
+					return true;
+				}
+				++y_index;
+				for (BigInteger* v : {numer, denom}) {
+					BigInteger new_xy = v[xy] * t + v[x_only];
+					BigInteger new_y = v[y_only] * t + v[constant];
+					v[x_only] = std::move(v[xy]);
+					v[constant] = std::move(v[y_only]);
+					v[xy] = std::move(new_xy);
+					v[y_only] = std::move(new_y);
+				}
+				return true;
+			}
+
+			/**
+			 * Stores numerator and denominator of <tt>z</tt> at a corner of the range of the inputs: <tt>xy</tt>
+			 * for both infinite, <tt>x_only</tt> for <tt>x</tt> infinite and <tt>y = 1</tt>, <tt>y_only</tt> the
+			 * other way round, <tt>constant</tt> for both 1.
+			 */
+			void corner(int which, BigInteger &n, BigInteger &d) const {
+				n = numer[xy];
+				d = denom[xy];
+				if (which != y_only && which != xy) {
+					n += numer[x_only];
+					d += denom[x_only];
+				}
+				if (which != x_only && which != xy) {
+					n += numer[y_only];
+					d += denom[y_only];
+				}
+				if (which == constant) {
+					n += numer[constant];
+					d += denom[constant];
+				}
+			}
+
+			/**
+			 * \brief Stores the common integer part of <tt>z</tt> at all corners.
+			 *
+			 * Corners where numerator and denominator both vanish are left out, since the value there lies
+			 * between that of its neighbours. That includes the corners of an input that ended, whose
+			 * coefficients have been cleared.
+			 *
+			 * @return <tt>false</tt> if they differ or <tt>z</tt> may have a pole in between.
+			 */
+			bool settled(BigInteger &out) const {
+				int sign = 0;
+				BigInteger n, d;
+				for (int i = xy; i <= constant; ++i) {
+					corner(i, n, d);
+					if (n.is_zero() && d.is_zero()) continue;
+					if (d.is_zero() || (sign != 0 && d.sign() != sign)) return false;
+					BigInteger t = BigInteger::floor_divide(n, d);
+					if (sign == 0) out = std::move(t);
+					else if (t != out) return false;
+					sign = d.sign();
+				}
+				return sign != 0;
+			}
+
+			/**
+			 * @return Whether the range of <tt>x</tt> moves <tt>z</tt> more than that of <tt>y</tt>, judged from
+			 *         <tt>x = 1</tt> and <tt>y = 1</tt> to either being infinite. A pole counts as infinitely much.
+			 */
+			bool x_wider() const {
+				BigInteger n_x, d_x, n_y, d_y, n_1, d_1;
+				corner(x_only, n_x, d_x);
+				corner(y_only, n_y, d_y);
+				corner(constant, n_1, d_1);
+				bool x_pole = d_x.is_zero() || d_1.is_zero() || d_x.sign() != d_1.sign();
+				bool y_pole = d_y.is_zero() || d_1.is_zero() || d_y.sign() != d_1.sign();
+				if (x_pole || y_pole) return x_pole && (!y_pole || x_index <= y_index);
+				// |n_x/d_x - n_1/d_1| >= |n_y/d_y - n_1/d_1|, multiplied by |d_x d_y d_1|
+				BigInteger spread_x = (n_x * d_1 - n_1 * d_x) * d_y;
+				BigInteger spread_y = (n_y * d_1 - n_1 * d_y) * d_x;
+				if (spread_x.sign() < 0) spread_x = -spread_x;
+				if (spread_y.sign() < 0) spread_y = -spread_y;
+				return spread_x >= spread_y;
+			}
+
+		protected:
+			bool next(BigInteger &out) override {
+				const std::size_t start_bits = bits();
+				for (std::size_t ingested = 0; ; ++ingested) {
+					bool infinite = true;
+					for (const BigInteger &v : denom) infinite = infinite && v.is_zero();
+					if (infinite) return false;
+
+					if (x_index > 0 && y_index > 0 && settled(out)) {
+						for (int i = 0; i < 4; ++i) {
+							BigInteger rest = numer[i] - out * denom[i];
+							numer[i] = std::move(denom[i]);
+							denom[i] = std::move(rest);
+						}
+						return true;
+					}
+					if (ingested >= NPASSON_CF_INGESTION_LIMIT || bits() > start_bits + NPASSON_CF_COEFFICIENT_BITS) return false;
+
+					bool ok;
+					if (diagonal) {
+						// both read the same term
+						ok = ingest_x() && ingest_y();
+						fold();
+					} else if (x_index == 0) ok = ingest_x();
+					else if (y_index == 0) ok = ingest_y();
+					else if (x_done) ok = ingest_y();
+					else if (y_done) ok = ingest_x();
+					else ok = x_wider() ? ingest_x() : ingest_y();
+					if (!ok) return false;
+				}
+			}
+
+		public:
+			GosperStream(std::shared_ptr<TermStream> x, std::shared_ptr<TermStream> y, const long long signed int (&coefficients)[8])
+				: x(x), y(y), diagonal(x == y) {
+				for (int i = 0; i < 4; ++i) {
+					numer[i] = coefficients[i];
+					denom[i] = coefficients[4 + i];
+				}
+				if (diagonal) fold();
+			}
+		};
+	}
+
+	ContinuedFraction::ContinuedFraction(std::shared_ptr<detail::TermStream> stream) : stream(std::move(stream)) {}
+
+	/**
+	 * Expands <tt>frac</tt>, which takes no more terms than Euclid's algorithm takes steps on it.
+	 */
+	ContinuedFraction::ContinuedFraction(const Fraction &frac) {
+		long long signed int num = frac.num(), den = frac.den();
+		if (!frac.valid()) den = 0;
+		if (den < 0) {
+			num = -num;
+			den = -den;
+		}
+		stream = std::make_shared<detail::RationalStream>(BigInteger(num), BigInteger(den));
+	}
+
+	/**
+	 * \brief The quadratic irrational <tt>(p + sqrt(d)) / q</tt>.
+	 *
+	 * Its expansion is periodic and computed with integers only. A perfect square <tt>d</tt> gives the rational
+	 * value, and a negative <tt>d</tt> or zero <tt>q</tt> a value without terms.
+	 */
+	ContinuedFraction ContinuedFraction::quadratic(const BigInteger &p, const BigInteger &d, const BigInteger &q) {
+		if (d.sign() < 0 || q.is_zero()) {
+			return ContinuedFraction(std::make_shared<detail::RationalStream>(BigInteger(0), BigInteger(0)));
+		}
+		BigInteger s = detail::QuadraticStream::integer_sqrt(d);
+		if (s * s == d) {
+			BigInteger num = p + s, den = q;
+			if (den.sign() < 0) {
+				num = -num;
+				den = -den;
+			}
+			return ContinuedFraction(std::make_shared<detail::RationalStream>(num, den));
+		}
+		return ContinuedFraction(std::make_shared<detail::QuadraticStream>(p, d, q, s));
+	}
+
+	/**
+	 * \brief The square root of <tt>frac</tt>, as <tt>sqrt(num * den) / den</tt>.
+	 *
+	 * A negative or invalid <tt>frac</tt> gives a value without terms.
+	 */
+	ContinuedFraction ContinuedFraction::sqrt(const Fraction &frac) {
+		long long signed int num = frac.num(), den = frac.den();
+		if (den < 0) {
+			num = -num;
+			den = -den;
+		}
+		if (!frac.valid() || num < 0) return quadratic(BigInteger(0), BigInteger(-1), BigInteger(1));
+		return quadratic(BigInteger(0), BigInteger(num) * den, BigInteger(den));
+	}
+
+	/**
+	 * Stores term <tt>i</tt> in <tt>out</tt>, with <tt>a0</tt>, the floor of the value, as term 0.
+	 *
+	 * @return <tt>false</tt> if the expansion ends before, or the term cannot be decided (see
+	 *         <tt>NPASSON_CF_INGESTION_LIMIT</tt> and <tt>NPASSON_CF_COEFFICIENT_BITS</tt>).
+	 */
+	bool ContinuedFraction::term(std::size_t i, BigInteger &out) const {
+		return stream->term(i, out);
+	}
+
+	/**
+	 * @return The first <tt>count</tt> terms, or fewer if the expansion ends before.
+	 */
+	std::vector<BigInteger> ContinuedFraction::terms(std::size_t count) const {
+		std::vector<BigInteger> result;
+		BigInteger t;
+		for (std::size_t i = 0; i < count && stream->term(i, t); ++i) result.push_back(t);
+		return result;
+	}
+
+	/**
+	 * \brief Convergent <tt>i</tt>, the value of the expansion cut after term <tt>i</tt>.
+	 *
+	 * Convergents are the best approximations for their size. Past the end of a finite expansion this is the
+	 * exact value.
+	 *
+	 * @return The convergent, or an invalid Fraction if it does not fit or there are no terms.
+	 */
+	Fraction ContinuedFraction::convergent(std::size_t i) const {
+		BigInteger p(1), q(0), p_prev(0), q_prev(1), t;
+		std::size_t k = 0;
+		for (; k <= i && stream->term(k, t); ++k) {
+			BigInteger p_next = t * p + p_prev;
+			BigInteger q_next = t * q + q_prev;
+			p_prev = std::move(p);
+			q_prev = std::move(q);
+			p = std::move(p_next);
+			q = std::move(q_next);
+		}
+		long long signed int num, den;
+		if (k == 0 || !p.to_long_long(num) || !q.to_long_long(den)) return INVALID_FRACTION;
+		return Fraction(num, den);
+	}
+
+	/**
+	 * \brief The decimal expansion, truncated after <tt>digits</tt> places.
+	 *
+	 * Digits are produced like terms, by a homographic transform <tt>(a x + b) / (c x + d)</tt> of the value
+	 * that takes terms until the next digit is settled, then multiplies the rest by ten. A finite expansion
+	 * stops early; a digit that cannot be decided (see <tt>NPASSON_CF_INGESTION_LIMIT</tt> and
+	 * <tt>NPASSON_CF_COEFFICIENT_BITS</tt>) ends the output.
+	 *
+	 * @param digits The number of places after the decimal point.
+	 * @return The value as e.g. <tt>"-1.4142"</tt> or <tt>"3"</tt>, without a sign if all emitted digits are zero,
+	 *         or an empty string if there are no terms.
+	 */
+	std::string ContinuedFraction::decimal(std::size_t digits) const {
+		BigInteger t;
+		if (!stream->term(0, t)) return "";
+		bool negative = t.sign() < 0;
+		// the transform starts at the magnitude, the integer part is its first digit
+		BigInteger a(negative ? -1 : 1), b(0), c(0), d(1);
+		std::size_t index = 0;
+		bool done = false;
+		bool nonzero = false;
+		std::string result;
+		// the sign goes in front only once a nonzero digit shows that the truncated value is not zero
+		auto finished = [&]() {return (negative && nonzero) ? "-" + result : result;};
+		auto bits = [&]() {return std::max(std::max(a.bit_length(), b.bit_length()), std::max(c.bit_length(), d.bit_length()));};
+		for (std::size_t emitted = 0; emitted <= digits; ++emitted) {
+			BigInteger digit;
+			std::size_t ingested = 0;
+			const std::size_t start_bits = bits();
+			while (true) {
+				// after the first term the rest of the value lies in [1, inf]
+				if (index > 0 && c.sign() != 0 && c.sign() == (c + d).sign()) {
+					digit = BigInteger::floor_divide(a, c);
+					if (BigInteger::floor_divide(a + b, c + d) == digit) break;
+				}
+				if (done || ingested++ >= NPASSON_CF_INGESTION_LIMIT || bits() > start_bits + NPASSON_CF_COEFFICIENT_BITS) {
+					return finished();
+				}
+				if (stream->term(index, t)) {
+					++index;
+					BigInteger new_a = a * t + b;
+					BigInteger new_c = c * t + d;
+					b = std::move(a);
+					d = std::move(c);
+					a = std::move(new_a);
+					c = std::move(new_c);
+				} else {
+					// the value is exact now: x = inf
+					done = true;
+					b = a;
+					d = c;
+					if (c.is_zero()) return finished();
+				}
+			}
+			// the point only goes in once a digit follows it
+			if (emitted == 1) result += ".";
+			result += digit.str();
+			nonzero = nonzero || !digit.is_zero();
+			a = (a - digit * c) * 10;
+			b = (b - digit * d) * 10;
+			if (done && a.is_zero()) break;
+		}
+		return finished();
+	}
+
+	/**
+	 * \brief <tt>(a xy + b x + c y + d) / (e xy + f x + g y + h)</tt> of <tt>x</tt> and <tt>y</tt>.
+	 *
+	 * On two copies of a value whose closed form <tt>(p + sqrt(s)) / q</tt> is known, the result is computed
+	 * exactly. It is <tt>(U1 + V1 sqrt(s)) / (U2 + V2 sqrt(s))</tt>, which the conjugate of the denominator turns
+	 * into <tt>(U + V sqrt(s)) / W</tt>, again a rational or quadratic irrational.
+	 *
+	 * @param coefficients <tt>a</tt> to <tt>h</tt>.
+	 */
+	ContinuedFraction ContinuedFraction::combine(const ContinuedFraction &x, const ContinuedFraction &y,
+	                                             const long long signed int (&coefficients)[8]) {
+		BigInteger p, s, q;
+		if (x.stream != y.stream || !x.stream->closed_form(p, s, q)) {
+			return ContinuedFraction(std::make_shared<detail::GosperStream>(x.stream, y.stream, coefficients));
+		}
+		// q^2 x^2 = p^2 + s + 2p sqrt(s) and q^2 x = pq + q sqrt(s)
+		const BigInteger square = p * p + s, cross = p * 2, pq = p * q, qq = q * q;
+		BigInteger u[2], v[2];
+		for (int i = 0; i < 2; ++i) {
+			const long long signed int* c = coefficients + 4 * i;
+			BigInteger linear = BigInteger(c[1]) + c[2];
+			u[i] = square * c[0] + pq * linear + qq * c[3];
+			v[i] = cross * c[0] + q * linear;
+		}
+		BigInteger numerator = u[0] * u[1] - v[0] * v[1] * s;
+		BigInteger root = v[0] * u[1] - u[0] * v[1];
+		BigInteger denominator = u[1] * u[1] - v[1] * v[1] * s;
+		if (denominator.is_zero()) {
+			return ContinuedFraction(std::make_shared<detail::RationalStream>(BigInteger(0), BigInteger(0)));
+		}
+		// a common factor would only make every later term more expensive
+		BigInteger divisor = detail::continued_fraction_gcd(detail::continued_fraction_gcd(numerator, root), denominator);
+		numerator /= divisor;
+		root /= divisor;
+		denominator /= divisor;
+		if (denominator.sign() < 0) {
+			numerator = -numerator;
+			root = -root;
+			denominator = -denominator;
+		}
+		if (root.is_zero() || s.is_zero()) {
+			return ContinuedFraction(std::make_shared<detail::RationalStream>(numerator, denominator));
+		}
+		// (U + V sqrt(s)) / W = (U - |V| sqrt(s)) / W = (-U + sqrt(V^2 s)) / -W for negative V
+		if (root.sign() < 0) {
+			numerator = -numerator;
+			root = -root;
+			denominator = -denominator;
+		}
+		return quadratic(numerator, root * root * s, denominator);
+	}
+
+	ContinuedFraction ContinuedFraction::operator-() const {
+		static const long long signed int negate[8] = {0, -1, 0, 0,  0, 0, 0, 1};
+		return combine(*this, *this, negate);
+	}
+
+	ContinuedFraction operator+(const ContinuedFraction &lhs, const ContinuedFraction &rhs) {
+		static const long long signed int plus[8] = {0, 1, 1, 0,  0, 0, 0, 1};
+		return ContinuedFraction::combine(lhs, rhs, plus);
+	}
+
+	ContinuedFraction operator-(const ContinuedFraction &lhs, const ContinuedFraction &rhs) {
+		static const long long signed int minus[8] = {0, 1, -1, 0,  0, 0, 0, 1};
+		return ContinuedFraction::combine(lhs, rhs, minus);
+	}
+
+	ContinuedFraction operator*(const ContinuedFraction &lhs, const ContinuedFraction &rhs) {
+		static const long long signed int multiplies[8] = {1, 0, 0, 0,  0, 0, 0, 1};
+		return ContinuedFraction::combine(lhs, rhs, multiplies);
+	}
+
+	ContinuedFraction operator/(const ContinuedFraction &lhs, const ContinuedFraction &rhs) {
+		static const long long signed int divides[8] = {0, 1, 0, 0,  0, 0, 1, 0};
+		return ContinuedFraction::combine(lhs, rhs, divides);
+	}
+}
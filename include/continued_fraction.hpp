@@ -0,0 +1,113 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file continued_fraction.hpp
+ * Contains ContinuedFraction, real numbers as lazily evaluated continued fractions.
+ */
+
+#ifndef NPASSON_CONTINUED_FRACTION_HPP
+#define NPASSON_CONTINUED_FRACTION_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "big_integer.hpp"
+#include "fraction.hpp"
+
+// Gosper's algorithm cannot decide the next term if the exact result is rational but an input is not, as in
+// (sqrt(2) + 0) * (sqrt(2) + 0), since every bound of the result then still straddles an integer. It gives up
+// after this many input terms without producing a term, or once its coefficients grew by this many bits, which
+// ends the result.
+#ifndef NPASSON_CF_INGESTION_LIMIT
+#define NPASSON_CF_INGESTION_LIMIT 4096
+#endif
+#ifndef NPASSON_CF_COEFFICIENT_BITS
+#define NPASSON_CF_COEFFICIENT_BITS 512
+#endif
+
+namespace npasson {
+
+	namespace detail {
+		class TermStream;
+	}
+
+	/**
+	 * \brief A real number as a simple continued fraction <tt>a0 + 1/(a1 + 1/(a2 + ...))</tt>, computed term by
+	 * term on demand.
+	 *
+	 * Values come from Fractions, which have finite expansions, or from quadratic irrationals like
+	 * <tt>sqrt(2)</tt>, whose expansions are infinite but periodic. Arithmetic builds a lazy expression: each
+	 * result pulls terms from its operands only as far as needed to settle its own next term, using Gosper's
+	 * bihomographic algorithm on arbitrary precision integers. So an expression of any depth costs only what
+	 * the terms or digits actually asked for cost, and memory grows with the precision consumed.
+	 *
+	 * Copies share their terms, which are cached once computed. An operation on two copies of one value is
+	 * computed on that value alone: exactly if it is a Fraction or quadratic irrational, so that
+	 * <tt>sqrt(2) * sqrt(2)</tt> is 2, and otherwise by feeding each term into both operands at once, so that
+	 * <tt>x - x</tt> is 0. ContinuedFraction is not thread-safe, not even between copies. An invalid Fraction
+	 * gives a value without any terms, as does any arithmetic on it.
+	 */
+	class ContinuedFraction {
+
+	private:
+		std::shared_ptr<detail::TermStream> stream;
+
+		explicit ContinuedFraction(std::shared_ptr<detail::TermStream>);
+		static ContinuedFraction combine(const ContinuedFraction&, const ContinuedFraction&, const long long signed int (&)[8]);
+
+	public:
+		ContinuedFraction(const Fraction&); // NOLINT
+		static ContinuedFraction quadratic(const BigInteger&, const BigInteger&, const BigInteger&);
+		static ContinuedFraction sqrt(const Fraction&);
+
+		bool term(std::size_t, BigInteger&) const;
+		std::vector<BigInteger> terms(std::size_t) const;
+		Fraction convergent(std::size_t) const;
+		std::string decimal(std::size_t) const;
+
+		ContinuedFraction operator - () const;
+
+		friend ContinuedFraction operator + (const ContinuedFraction&, const ContinuedFraction&);
+		friend ContinuedFraction operator - (const ContinuedFraction&, const ContinuedFraction&);
+		friend ContinuedFraction operator * (const ContinuedFraction&, const ContinuedFraction&);
+		friend ContinuedFraction operator / (const ContinuedFraction&, const ContinuedFraction&);
+	};
+
+	// Fraction's own operator templates would otherwise take a ContinuedFraction operand and reject it
+
+	inline ContinuedFraction operator + (const Fraction &lhs, const ContinuedFraction &rhs) {return ContinuedFraction(lhs) + rhs;}
+	inline ContinuedFraction operator - (const Fraction &lhs, const ContinuedFraction &rhs) {return ContinuedFraction(lhs) - rhs;}
+	inline ContinuedFraction operator * (const Fraction &lhs, const ContinuedFraction &rhs) {return ContinuedFraction(lhs) * rhs;}
+	inline ContinuedFraction operator / (const Fraction &lhs, const ContinuedFraction &rhs) {return ContinuedFraction(lhs) / rhs;}
+	inline ContinuedFraction operator + (const ContinuedFraction &lhs, const Fraction &rhs) {return lhs + ContinuedFraction(rhs);}
+	inline ContinuedFraction operator - (const ContinuedFraction &lhs, const Fraction &rhs) {return lhs - ContinuedFraction(rhs);}
+	inline ContinuedFraction operator * (const ContinuedFraction &lhs, const Fraction &rhs) {return lhs * ContinuedFraction(rhs);}
+	inline ContinuedFraction operator / (const ContinuedFraction &lhs, const Fraction &rhs) {return lhs / ContinuedFraction(rhs);}
+}
+
+#ifdef NPASSON_EXPERIMENTAL_COMPILE
+#include "continued_fraction.cpp"
+#endif
+
+#endif //NPASSON_CONTINUED_FRACTION_HPP
@@ -0,0 +1,319 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file dyadic_fraction.cpp
+ * The code of the DyadicFraction class.
+ */
+
+#include <cmath>
+
+#ifndef NPASSON_EXPERIMENTAL_COMPILE
+	#include "dyadic_fraction.hpp"
+#endif
+
+#include "fraction_expression.hpp"
+
+namespace npasson {
+
+	namespace detail {
+
+		inline int trailing_zeros(unsigned long long int x) {
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_ctzll(x);
+#else
+			int count = 0;
+			while (!(x & 1)) { x >>= 1; ++count; }
+			return count;
+#endif
+		}
+
+		inline int bit_length(unsigned long long int x) {
+#if defined(__GNUC__) || defined(__clang__)
+			return x ? 64 - __builtin_clzll(x) : 0;
+#else
+			int len = 0;
+			while (x) { x >>= 1; ++len; }
+			return len;
+#endif
+		}
+
+		inline unsigned long long int magnitude(long long signed int x) {
+			return (x < 0) ? 0ull - static_cast<unsigned long long int>(x) : static_cast<unsigned long long int>(x);
+		}
+
+#if defined(__SIZEOF_INT128__)
+		/**
+		 * Compares <tt>mant * 2^exp</tt> exactly against a Fraction, which it may exceed in range.
+		 */
+		inline int compare_dyadic(long long signed int mant, int exp, const Fraction &frac) {
+			long long signed int num = frac.num();
+			long long signed int den = frac.den();
+			int lhs_sign = (mant > 0) - (mant < 0);
+			int rhs_sign = ((num > 0) - (num < 0)) * ((den < 0) ? -1 : 1);
+			if (lhs_sign != rhs_sign) return (lhs_sign > rhs_sign) ? 1 : -1;
+			if (lhs_sign == 0) return 0;
+
+			// compare |mant| * |den| * 2^exp against |num|, shifting whichever side has the positive exponent
+			unsigned __int128 lhs = static_cast<unsigned __int128>(magnitude(mant)) * magnitude(den);
+			unsigned __int128 rhs = magnitude(num);
+			auto bits = [](unsigned __int128 x) {
+				unsigned long long int high = static_cast<unsigned long long int>(x >> 64);
+				return high ? 64 + bit_length(high) : bit_length(static_cast<unsigned long long int>(x));
+			};
+			int result;
+			if (exp >= 0 && bits(lhs) + static_cast<long long signed int>(exp) > 127) {
+				result = 1;
+			} else if (exp < 0 && bits(rhs) - static_cast<long long signed int>(exp) > 127) {
+				result = -1;
+			} else {
+				if (exp >= 0) lhs <<= exp;
+				else rhs <<= -exp;
+				result = (lhs > rhs) - (lhs < rhs);
+			}
+			return lhs_sign * result;
+		}
+#endif
+
+		/**
+		 * Shifts <tt>x</tt> left by <tt>shift</tt> bits if the result still fits into 63 bits.
+		 */
+		inline bool shift_left(long long signed int x, int shift, long long signed int &result) {
+			if (shift >= 63 || bit_length(magnitude(x)) + shift > 62) return false;
+			result = (x < 0) ? -static_cast<long long signed int>(magnitude(x) << shift)
+			                 :  static_cast<long long signed int>(magnitude(x) << shift);
+			return true;
+		}
+	}
+
+	/**
+	 * Makes the mantissa odd, or the whole value 0 * 2^0.
+	 */
+	void DyadicFraction::normalize() {
+		if (mant == 0) {
+			exp = 0;
+			return;
+		}
+		int zeros = detail::trailing_zeros(detail::magnitude(mant));
+		if (zeros) {
+			unsigned long long int shifted = detail::magnitude(mant) >> zeros;
+			mant = (mant < 0) ? -static_cast<long long signed int>(shifted) : static_cast<long long signed int>(shifted);
+			exp += zeros;
+		}
+	}
+
+	/**
+	 * Wraps a general Fraction.
+	 */
+	DyadicFraction DyadicFraction::promoted(const Fraction &frac) {
+		DyadicFraction result;
+		result.general = true;
+		result.fraction = frac;
+		return result;
+	}
+
+	DyadicFraction::DyadicFraction(long long signed int value) : mant(value) {
+		normalize();
+	}
+
+	/**
+	 * Converts a <tt>double</tt> exactly. Infinities and NaN become an invalid general Fraction.
+	 *
+	 * @param value Any <tt>double</tt>.
+	 */
+	DyadicFraction::DyadicFraction(double value) {
+		if (!std::isfinite(value)) {
+			general = true;
+			fraction = INVALID_FRACTION;
+			return;
+		}
+		int e;
+		double m = std::frexp(value, &e);
+		// |m| is in [0.5, 1), so scaling by 2^53 leaves an integer
+		mant = static_cast<long long signed int>(std::ldexp(m, 53));
+		exp = e - 53;
+		normalize();
+	}
+
+	/**
+	 * Converts a Fraction, staying dyadic if its denominator is a power of two.
+	 *
+	 * @param frac The value to convert.
+	 */
+	DyadicFraction::DyadicFraction(const Fraction &frac) {
+		long long signed int den = frac.den();
+		if (!frac.valid() || den <= 0 || (den & (den - 1)) != 0) {
+			general = true;
+			fraction = frac;
+			return;
+		}
+		mant = frac.num();
+		exp = -detail::trailing_zeros(static_cast<unsigned long long int>(den));
+		normalize();
+	}
+
+	/**
+	 * Creates <tt>mantissa * 2^exponent</tt>.
+	 */
+	DyadicFraction DyadicFraction::from_parts(long long signed int mantissa, int exponent) {
+		DyadicFraction result;
+		result.mant = mantissa;
+		result.exp = exponent;
+		result.normalize();
+		return result;
+	}
+
+	/**
+	 * Returns the value as a Fraction. Dyadic values beyond the range of Fraction become invalid.
+	 *
+	 * @return <tt>this</tt> as a Fraction.
+	 */
+	Fraction DyadicFraction::to_fraction() const {
+		if (general) return fraction;
+		if (exp >= 0) {
+			long long signed int value;
+			if (!detail::shift_left(mant, exp, value)) return INVALID_FRACTION;
+			return Fraction(value);
+		}
+		if (exp < -62) return INVALID_FRACTION;
+		return Fraction(mant, 1ll << -exp);
+	}
+
+	/**
+	 * @return <tt>this</tt> as a correctly rounded <tt>double</tt>, as long as it is not subnormal.
+	 */
+	double DyadicFraction::to_double() const {
+		if (general) return fraction.to_double();
+		return std::ldexp(static_cast<double>(mant), exp);
+	}
+
+	/* === OPERATORS === */
+
+	DyadicFraction& DyadicFraction::operator+=(const DyadicFraction &rhs) {
+		if (!general && !rhs.general) {
+			// zero is stored as 0 * 2^0, aligning against it could shift the other operand out of range
+			if (rhs.mant == 0) return *this;
+			if (mant == 0) return ((*this) = rhs);
+			// align to the smaller exponent
+			const DyadicFraction &low  = (exp <= rhs.exp) ? *this : rhs;
+			const DyadicFraction &high = (exp <= rhs.exp) ? rhs : *this;
+			long long signed int aligned, sum;
+			if (detail::shift_left(high.mant, high.exp - low.exp, aligned)
+			 && !(aligned > 0 && low.mant > 9223372036854775807ll - aligned)
+			 && !(aligned < 0 && low.mant < -9223372036854775807ll - aligned)) {
+				sum = aligned + low.mant;
+				exp = low.exp;
+				mant = sum;
+				normalize();
+				return *this;
+			}
+		}
+		return ((*this) = DyadicFraction((lazy(to_fraction()) + rhs.to_fraction()).eval()));
+	}
+	DyadicFraction  DyadicFraction::operator+ (const DyadicFraction &rhs) const {
+		DyadicFraction temp = (*this);
+		return temp += rhs;
+	}
+
+	DyadicFraction& DyadicFraction::operator-=(const DyadicFraction &rhs) {
+		return (*this) += -rhs;
+	}
+	DyadicFraction  DyadicFraction::operator- (const DyadicFraction &rhs) const {
+		DyadicFraction temp = (*this);
+		return temp -= rhs;
+	}
+
+	DyadicFraction& DyadicFraction::operator*=(const DyadicFraction &rhs) {
+		if (!general && !rhs.general) {
+			// both mantissas are odd, so is their product, and nothing needs normalizing
+			if (detail::bit_length(detail::magnitude(mant)) + detail::bit_length(detail::magnitude(rhs.mant)) <= 63) {
+				mant *= rhs.mant;
+				exp = (mant == 0) ? 0 : exp + rhs.exp;
+				return *this;
+			}
+		}
+		return ((*this) = DyadicFraction((lazy(to_fraction()) * rhs.to_fraction()).eval()));
+	}
+	DyadicFraction  DyadicFraction::operator* (const DyadicFraction &rhs) const {
+		DyadicFraction temp = (*this);
+		return temp *= rhs;
+	}
+
+	DyadicFraction& DyadicFraction::operator/=(const DyadicFraction &rhs) {
+		if (!general && !rhs.general && (rhs.mant == 1 || rhs.mant == -1)) {
+			if (rhs.mant < 0) mant = -mant;
+			exp = (mant == 0) ? 0 : exp - rhs.exp;
+			return *this;
+		}
+		return ((*this) = DyadicFraction((lazy(to_fraction()) / rhs.to_fraction()).eval()));
+	}
+	DyadicFraction  DyadicFraction::operator/ (const DyadicFraction &rhs) const {
+		DyadicFraction temp = (*this);
+		return temp /= rhs;
+	}
+
+	DyadicFraction DyadicFraction::operator- () const {
+		DyadicFraction temp = (*this);
+		if (general) temp.fraction = -fraction;
+		else temp.mant = -mant;
+		return temp;
+	}
+
+	/**
+	 * \brief Three-way compares two DyadicFractions.
+	 *
+	 * Dyadic values are compared by sign, then by magnitude exponent, and only shifted against each other if
+	 * those agree.
+	 *
+	 * @param rhs The DyadicFraction to compare against.
+	 * @return <tt>-1</tt>, <tt>0</tt> or <tt>1</tt> if <tt>this</tt> is less than, equal to or greater than <tt>rhs</tt>.
+	 */
+	int DyadicFraction::compare(const DyadicFraction &rhs) const {
+		if (general && rhs.general) return fraction.compare(rhs.fraction);
+#if defined(__SIZEOF_INT128__)
+		if (general) return -detail::compare_dyadic(rhs.mant, rhs.exp, fraction);
+		if (rhs.general) return detail::compare_dyadic(mant, exp, rhs.fraction);
+#else
+		if (general || rhs.general) return to_fraction().compare(rhs.to_fraction());
+#endif
+
+		int lhs_sign = (mant > 0) - (mant < 0);
+		int rhs_sign = (rhs.mant > 0) - (rhs.mant < 0);
+		if (lhs_sign != rhs_sign) return (lhs_sign > rhs_sign) ? 1 : -1;
+		if (lhs_sign == 0) return 0;
+
+		unsigned long long int a = detail::magnitude(mant);
+		unsigned long long int b = detail::magnitude(rhs.mant);
+		// values lie in [2^(top-1), 2^top)
+		long long signed int lhs_top = static_cast<long long signed int>(detail::bit_length(a)) + exp;
+		long long signed int rhs_top = static_cast<long long signed int>(detail::bit_length(b)) + rhs.exp;
+		int result;
+		if (lhs_top != rhs_top) {
+			result = (lhs_top > rhs_top) ? 1 : -1;
+		} else {
+			// equal tops, so the shift is below 64 and cannot overflow
+			if (exp > rhs.exp) a <<= (exp - rhs.exp);
+			else b <<= (rhs.exp - exp);
+			result = (a > b) - (a < b);
+		}
+		return lhs_sign * result;
+	}
+}
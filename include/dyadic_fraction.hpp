@@ -0,0 +1,100 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file dyadic_fraction.hpp
+ * Contains the DyadicFraction type, a fraction whose denominator is a power of two.
+ */
+
+#ifndef NPASSON_DYADIC_FRACTION_HPP
+#define NPASSON_DYADIC_FRACTION_HPP
+
+#include "fraction.hpp"
+
+namespace npasson {
+
+	/**
+	 * \brief A fraction <tt>mantissa * 2^exponent</tt>, falling back to a general Fraction where needed.
+	 *
+	 * Every finite <tt>double</tt> is such a dyadic rational, and converting one is an exact <tt>frexp</tt>
+	 * instead of the string round trip of <tt>Fraction(double)</tt>. The mantissa is kept odd, so normalizing
+	 * is a count of trailing zeros and a shift, addition aligns exponents by shifting, and multiplication adds
+	 * them; no gcd is ever needed.
+	 *
+	 * Division by anything but a power of two, and shifts or products that would overflow the mantissa, promote
+	 * the value to a general Fraction and continue with Fraction arithmetic. Results of that which again have a
+	 * power of two denominator turn dyadic again. Promoting a dyadic value beyond the range of Fraction, or an
+	 * overflowing general result, gives an invalid Fraction.
+	 */
+	class DyadicFraction {
+
+	private:
+		long long signed int mant = 0;
+		int                  exp = 0;
+		bool                 general = false;
+		Fraction             fraction;
+
+		void normalize();
+		static DyadicFraction promoted(const Fraction&);
+
+	public:
+		DyadicFraction() = default;
+		DyadicFraction(long long signed int); // NOLINT
+		explicit DyadicFraction(double);
+		explicit DyadicFraction(const Fraction&);
+
+		static DyadicFraction from_parts(long long signed int, int);
+
+		bool is_dyadic() const {return !general;}
+		long long signed int mantissa() const {return mant;}
+		int exponent() const {return exp;}
+
+		Fraction to_fraction() const;
+		double   to_double() const;
+		explicit operator Fraction() const {return to_fraction();}
+		explicit operator double() const {return to_double();}
+
+		DyadicFraction& operator += (const DyadicFraction&);
+		DyadicFraction  operator +  (const DyadicFraction&) const;
+		DyadicFraction& operator -= (const DyadicFraction&);
+		DyadicFraction  operator -  (const DyadicFraction&) const;
+		DyadicFraction& operator *= (const DyadicFraction&);
+		DyadicFraction  operator *  (const DyadicFraction&) const;
+		DyadicFraction& operator /= (const DyadicFraction&);
+		DyadicFraction  operator /  (const DyadicFraction&) const;
+		DyadicFraction  operator -  () const;
+
+		int compare(const DyadicFraction&) const;
+
+		bool operator==(const DyadicFraction &rhs) const {return compare(rhs) == 0;}
+		bool operator!=(const DyadicFraction &rhs) const {return compare(rhs) != 0;}
+		bool operator< (const DyadicFraction &rhs) const {return compare(rhs) <  0;}
+		bool operator> (const DyadicFraction &rhs) const {return compare(rhs) >  0;}
+		bool operator<=(const DyadicFraction &rhs) const {return compare(rhs) <= 0;}
+		bool operator>=(const DyadicFraction &rhs) const {return compare(rhs) >= 0;}
+	};
+}
+
+#ifdef NPASSON_EXPERIMENTAL_COMPILE
+#include "dyadic_fraction.cpp"
+#endif
+
+#endif //NPASSON_DYADIC_FRACTION_HPP
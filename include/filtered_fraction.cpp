@@ -0,0 +1,102 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file filtered_fraction.cpp
+ * The code of the FilteredFraction class.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#ifndef NPASSON_EXPERIMENTAL_COMPILE
+	#include "filtered_fraction.hpp"
+#endif
+
+namespace npasson {
+
+	namespace detail {
+		thread_local FilteredFraction::Stats filtered_fraction_stats = {0, 0};
+	}
+
+	/**
+	 * Wraps a Fraction and computes its shadow, the correctly rounded <tt>double</tt>.
+	 *
+	 * @param frac The exact value.
+	 */
+	FilteredFraction::FilteredFraction(const Fraction &frac) : exact(frac), shadow(frac.to_double()) {}
+
+	/**
+	 * The slow path of <tt>compare()</tt>, taken when both shadows are equal (or NaN for invalid Fractions).
+	 *
+	 * @param rhs The FilteredFraction to compare against.
+	 * @return The exact three-way comparison.
+	 */
+	int FilteredFraction::compare_exact(const FilteredFraction &rhs) const {
+		++detail::filtered_fraction_stats.fallbacks;
+		return exact.compare(rhs.exact);
+	}
+
+	/**
+	 * Returns a hash of the shadow. Equal values always have equal shadows, so this is consistent with
+	 * <tt>operator==</tt> without reducing the Fraction.
+	 *
+	 * @return The hash value.
+	 */
+	std::size_t FilteredFraction::hash() const {
+		return std::hash<double>()(shadow);
+	}
+
+	/**
+	 * \brief Sorts <tt>count</tt> Fractions ascending.
+	 *
+	 * Builds the shadows once, sorts on them and writes the Fractions back. Equivalent to <tt>std::sort</tt> on
+	 * the Fractions themselves, but almost all comparisons are <tt>double</tt> compares.
+	 *
+	 * @param fracs The Fractions to sort in place.
+	 * @param count The number of Fractions.
+	 */
+	void FilteredFraction::sort(Fraction* fracs, std::size_t count) {
+		std::vector<FilteredFraction> filtered(fracs, fracs + count);
+		std::sort(filtered.begin(), filtered.end());
+		for (std::size_t i = 0; i < count; ++i) {
+			fracs[i] = filtered[i].exact;
+		}
+	}
+
+	/**
+	 * Returns the comparison counters of the calling thread. Fallbacks are always counted; the total number of
+	 * comparisons only with NPASSON_INSTRUMENT, so the fast path stays a single <tt>double</tt> compare. With both,
+	 * <tt>fallbacks / comparisons</tt> is the fallback rate.
+	 *
+	 * @return The counters since the thread started or since the last <tt>reset_stats()</tt>.
+	 */
+	FilteredFraction::Stats FilteredFraction::stats() {
+		return detail::filtered_fraction_stats;
+	}
+
+	/**
+	 * Resets the comparison counters of the calling thread.
+	 */
+	void FilteredFraction::reset_stats() {
+		detail::filtered_fraction_stats = {0, 0};
+	}
+}
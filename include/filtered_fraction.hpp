@@ -0,0 +1,122 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file filtered_fraction.hpp
+ * Contains the FilteredFraction type, a Fraction with a cached floating point shadow for fast comparisons.
+ */
+
+#ifndef NPASSON_FILTERED_FRACTION_HPP
+#define NPASSON_FILTERED_FRACTION_HPP
+
+#include <cstddef>
+#include <functional>
+
+#include "fraction.hpp"
+
+namespace npasson {
+
+	/**
+	 * \brief A Fraction that carries its correctly rounded <tt>double</tt> along.
+	 *
+	 * Rounding to nearest is monotonic, so if the shadows of two FilteredFractions differ, their order is already
+	 * the order of the exact values. The exact values are within half an ulp of their shadows, and only when the
+	 * shadows are equal do these intervals overlap; then the comparison falls back to exact cross-multiplication.
+	 * In sorts and priority queues that is rare, so comparisons mostly cost one <tt>double</tt> compare.
+	 *
+	 * <tt>std::min</tt>, <tt>std::max</tt>, <tt>std::sort</tt> and friends take the fast path through
+	 * <tt>operator<</tt>. The type is opt-in: convert back with <tt>value()</tt> to do arithmetic.
+	 */
+	class FilteredFraction {
+
+	private:
+		Fraction exact;
+		double   shadow = 0.0;
+
+		int compare_exact(const FilteredFraction&) const;
+
+	public:
+		/**
+		 * Comparison counters of the calling thread.
+		 */
+		struct Stats {
+			unsigned long long int comparisons; ///< comparisons made, only counted with NPASSON_INSTRUMENT
+			unsigned long long int fallbacks;   ///< comparisons that needed exact arithmetic
+		};
+
+		FilteredFraction() = default;
+		FilteredFraction(const Fraction&); // NOLINT
+
+		const Fraction& value()  const {return exact;}
+		double          approx() const {return shadow;}
+
+		int compare(const FilteredFraction&) const;
+
+		bool operator==(const FilteredFraction &rhs) const {return compare(rhs) == 0;}
+		bool operator!=(const FilteredFraction &rhs) const {return compare(rhs) != 0;}
+		bool operator< (const FilteredFraction &rhs) const {return compare(rhs) <  0;}
+		bool operator> (const FilteredFraction &rhs) const {return compare(rhs) >  0;}
+		bool operator<=(const FilteredFraction &rhs) const {return compare(rhs) <= 0;}
+		bool operator>=(const FilteredFraction &rhs) const {return compare(rhs) >= 0;}
+
+		std::size_t hash() const;
+
+		static void sort(Fraction*, std::size_t);
+
+		static Stats stats();
+		static void reset_stats();
+	};
+
+	namespace detail {
+		extern thread_local FilteredFraction::Stats filtered_fraction_stats;
+	}
+
+	/**
+	 * \brief Three-way compares two FilteredFractions.
+	 *
+	 * @param rhs The FilteredFraction to compare against.
+	 * @return <tt>-1</tt>, <tt>0</tt> or <tt>1</tt> if <tt>this</tt> is less than, equal to or greater than <tt>rhs</tt>.
+	 */
+	inline int FilteredFraction::compare(const FilteredFraction &rhs) const {
+#ifdef NPASSON_INSTRUMENT
+		++detail::filtered_fraction_stats.comparisons;
+#endif
+		if (shadow < rhs.shadow) return -1;
+		if (shadow > rhs.shadow) return 1;
+		return compare_exact(rhs);
+	}
+}
+
+namespace std {
+	/**
+	 * Hashes a FilteredFraction by its shadow, which equal values share.
+	 */
+	template <>
+	struct hash<npasson::FilteredFraction> {
+		std::size_t operator()(const npasson::FilteredFraction &frac) const {return frac.hash();}
+	};
+}
+
+#ifdef NPASSON_EXPERIMENTAL_COMPILE
+#include "filtered_fraction.cpp"
+#endif
+
+#endif //NPASSON_FILTERED_FRACTION_HPP
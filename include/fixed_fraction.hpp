@@ -0,0 +1,304 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file fixed_fraction.hpp
+ * Contains the FixedFraction type, a fraction with a denominator fixed at compile time.
+ */
+
+#ifndef NPASSON_FIXED_FRACTION_HPP
+#define NPASSON_FIXED_FRACTION_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+#include "checked_arithmetic.hpp"
+#include "fraction.hpp"
+
+namespace npasson {
+
+	namespace detail {
+
+#if defined(__SIZEOF_INT128__)
+		typedef __int128 fixed_wide;
+#else
+		// without 128 bit integers products of large amounts overflow
+		typedef long long signed int fixed_wide;
+#endif
+
+		/**
+		 * The units of an invalid FixedFraction, outside the symmetric range of valid ones.
+		 */
+		const long long signed int fixed_invalid = -checked_limit - 1;
+
+		/**
+		 * Returns <tt>n/d</tt> for <tt>d > 0</tt>, rounded in the given direction, or <tt>fixed_invalid</tt> if
+		 * the quotient does not fit.
+		 */
+		inline long long signed int divide_rounded(fixed_wide n, fixed_wide d, RoundingMode mode) {
+			fixed_wide q = n / d;
+			fixed_wide r = n % d;
+			switch (mode) {
+				case RoundingMode::toward_zero:
+					break;
+				case RoundingMode::upward:
+					if (r > 0) ++q;
+					break;
+				case RoundingMode::downward:
+					if (r < 0) --q;
+					break;
+				case RoundingMode::to_nearest: {
+					// compares |r| against d - |r| instead of 2|r| against d, which could overflow without 128 bits
+					fixed_wide magnitude = (r < 0) ? -r : r;
+					if (magnitude > d - magnitude || (magnitude == d - magnitude && (q % 2) != 0)) q += (r < 0) ? -1 : 1;
+					break;
+				}
+			}
+			if (q > checked_limit || q < -checked_limit) return fixed_invalid;
+			return static_cast<long long signed int>(q);
+		}
+
+		/**
+		 * Returns <tt>a + b</tt>, or <tt>fixed_invalid</tt> if either operand is invalid or the sum does not fit.
+		 *
+		 * Uses only unsigned additions, logic and shifts, no comparisons, so loops over it vectorize even where the
+		 * vector unit cannot compare 64 bit lanes (plain SSE2).
+		 */
+		inline long long signed int fixed_add(long long signed int a, long long signed int b) {
+			typedef unsigned long long int bits;
+			const bits invalid = static_cast<bits>(fixed_invalid);
+			bits x = static_cast<bits>(a), y = static_cast<bits>(b), sum = x + y;
+			// the sign of the sum differs from both operand signs exactly on overflow
+			bits flags = (x ^ sum) & (y ^ sum);
+			// v - 1 & ~v has the top bit set only for v == 0, i.e. for values equal to the invalid one
+			bits ix = x ^ invalid, iy = y ^ invalid, isum = sum ^ invalid;
+			flags |= ((ix - 1) & ~ix) | ((iy - 1) & ~iy) | ((isum - 1) & ~isum);
+			bits mask = 0 - (flags >> 63);
+			return static_cast<long long signed int>((sum & ~mask) | (invalid & mask));
+		}
+
+		/**
+		 * Returns <tt>a * b</tt> in the wide type, or <tt>false</tt> if that overflows, which only happens without
+		 * 128 bit integers.
+		 */
+		inline bool fixed_product(long long signed int a, long long signed int b, fixed_wide &result) {
+#if defined(__SIZEOF_INT128__)
+			result = static_cast<fixed_wide>(a) * b;
+			return true;
+#else
+			return checked_mul(a, b, &result);
+#endif
+		}
+	}
+
+	/**
+	 * \brief A fraction with the denominator <tt>Den</tt> fixed at compile time.
+	 *
+	 * Stores only the numerator, the number of <tt>1/Den</tt> units, so addition and subtraction are plain integer
+	 * operations without any gcd, and an array of FixedFractions is an array of <tt>long long</tt>s that the
+	 * compiler can vectorize over (see <tt>add()</tt>). Multiplication and division have to rescale and round,
+	 * to nearest (ties to even) by default or as selected.
+	 *
+	 * Results beyond <tt>±LLONG_MAX</tt> units, division by zero and conversions of invalid Fractions give an
+	 * invalid FixedFraction, stored as the otherwise unused <tt>LLONG_MIN</tt> units. Like an invalid Fraction it
+	 * propagates through all further arithmetic, converts back to an invalid Fraction and orders after all valid
+	 * values.
+	 *
+	 * \code
+	 * typedef FixedFraction<100> Cents;
+	 * Cents price = Cents::from_units(1999); // 19.99
+	 * \endcode
+	 *
+	 * @tparam Den The denominator, e.g. <tt>100</tt> for cents or <tt>360</tt> for degrees.
+	 */
+	template <long long signed int Den>
+	class FixedFraction {
+		static_assert(Den > 0, "Error: FixedFraction needs a positive denominator");
+
+	private:
+		long long signed int units = 0;
+
+		// the negation of valid units, invalid ones stay invalid
+		static long long signed int valid_negation(long long signed int units) {
+			return (units == detail::fixed_invalid) ? units : -units;
+		}
+
+		// maps the units order preservingly onto the unsigned range, with the invalid value moved to the top
+		unsigned long long int order() const {
+			return static_cast<unsigned long long int>(units) + static_cast<unsigned long long int>(detail::checked_limit);
+		}
+
+	public:
+		static constexpr long long signed int denominator = Den;
+
+		FixedFraction() = default;
+
+		/**
+		 * Creates the integer <tt>value</tt>, i.e. <tt>value * Den</tt> units, or an invalid FixedFraction if that
+		 * does not fit.
+		 */
+		FixedFraction(long long signed int value) { // NOLINT
+			if (!detail::checked_mul(value, Den, &units)) units = detail::fixed_invalid;
+		}
+
+		/**
+		 * \brief Converts a Fraction, exactly if <tt>Den</tt> is a multiple of its denominator.
+		 *
+		 * @param frac The value to convert.
+		 * @param mode The rounding direction if <tt>frac</tt> is not representable.
+		 * \sa representable()
+		 */
+		explicit FixedFraction(const Fraction &frac, RoundingMode mode = RoundingMode::to_nearest) {
+			detail::fixed_wide n;
+			if (!frac.valid() || frac.den() == 0 || frac.den() < -detail::checked_limit
+			 || !detail::fixed_product(frac.num(), Den, n)) {
+				units = detail::fixed_invalid;
+				return;
+			}
+			detail::fixed_wide d = frac.den();
+			if (d < 0) {
+				n = -n;
+				d = -d;
+			}
+			units = detail::divide_rounded(n, d, mode);
+		}
+
+		/**
+		 * Creates a FixedFraction from its numerator.
+		 *
+		 * @param units The value in multiples of <tt>1/Den</tt>; <tt>LLONG_MIN</tt> gives an invalid FixedFraction.
+		 */
+		static FixedFraction from_units(long long signed int units) {
+			FixedFraction result;
+			result.units = units;
+			return result;
+		}
+
+		/**
+		 * @return If <tt>frac</tt> converts without rounding.
+		 */
+		static bool representable(const Fraction &frac) {
+			return frac.valid() && frac.den() != 0 && Den % frac.den() == 0 && FixedFraction(frac).valid();
+		}
+
+		long long signed int raw() const {return units;}
+		bool valid() const {return units != detail::fixed_invalid;}
+
+		/**
+		 * @return The exact value as a Fraction, or an invalid Fraction.
+		 */
+		Fraction to_fraction() const {return valid() ? Fraction(units, Den) : INVALID_FRACTION;}
+		explicit operator Fraction() const {return to_fraction();}
+
+		/* *** ADDITION, SUBTRACTION *** */
+
+		FixedFraction& operator+=(const FixedFraction &rhs) {return ((*this) = (*this) + rhs);}
+		FixedFraction& operator-=(const FixedFraction &rhs) {return ((*this) = (*this) - rhs);}
+		FixedFraction  operator+ (const FixedFraction &rhs) const {return from_units(detail::fixed_add(units, rhs.units));}
+		FixedFraction  operator- (const FixedFraction &rhs) const {return from_units(detail::fixed_add(units, valid_negation(rhs.units)));}
+		FixedFraction  operator- () const {return from_units(valid_negation(units));}
+
+		/* *** MULTIPLICATION, DIVISION *** */
+
+		/**
+		 * \brief Multiplies and rounds the product back to multiples of <tt>1/Den</tt>.
+		 *
+		 * @param rhs The factor.
+		 * @param mode The rounding direction.
+		 * @return <tt>this * rhs</tt>, rounded.
+		 */
+		FixedFraction multiply(const FixedFraction &rhs, RoundingMode mode = RoundingMode::to_nearest) const {
+			detail::fixed_wide n;
+			if (!valid() || !rhs.valid() || !detail::fixed_product(units, rhs.units, n)) return from_units(detail::fixed_invalid);
+			return from_units(detail::divide_rounded(n, Den, mode));
+		}
+
+		/**
+		 * \brief Divides and rounds the quotient to multiples of <tt>1/Den</tt>.
+		 *
+		 * @param rhs The divisor.
+		 * @param mode The rounding direction.
+		 * @return <tt>this / rhs</tt>, rounded, or an invalid FixedFraction if <tt>rhs</tt> is zero.
+		 */
+		FixedFraction divide(const FixedFraction &rhs, RoundingMode mode = RoundingMode::to_nearest) const {
+			detail::fixed_wide n;
+			if (!valid() || !rhs.valid() || rhs.units == 0 || !detail::fixed_product(units, Den, n)) {
+				return from_units(detail::fixed_invalid);
+			}
+			detail::fixed_wide d = rhs.units;
+			if (d < 0) {
+				n = -n;
+				d = -d;
+			}
+			return from_units(detail::divide_rounded(n, d, mode));
+		}
+
+		FixedFraction& operator*=(const FixedFraction &rhs) {return ((*this) = multiply(rhs));}
+		FixedFraction& operator/=(const FixedFraction &rhs) {return ((*this) = divide(rhs));}
+		FixedFraction  operator* (const FixedFraction &rhs) const {return multiply(rhs);}
+		FixedFraction  operator/ (const FixedFraction &rhs) const {return divide(rhs);}
+
+		// scaling by an integer is exact
+		FixedFraction& operator*=(long long signed int rhs) {return ((*this) = (*this) * rhs);}
+		FixedFraction  operator* (long long signed int rhs) const {
+			long long signed int product;
+			return from_units(detail::checked_mul(units, rhs, &product) ? product : detail::fixed_invalid);
+		}
+
+		/* *** COMPARISON *** */
+
+		bool operator==(const FixedFraction &rhs) const {return units == rhs.units;}
+		bool operator!=(const FixedFraction &rhs) const {return units != rhs.units;}
+		bool operator< (const FixedFraction &rhs) const {return order() <  rhs.order();}
+		bool operator> (const FixedFraction &rhs) const {return order() >  rhs.order();}
+		bool operator<=(const FixedFraction &rhs) const {return order() <= rhs.order();}
+		bool operator>=(const FixedFraction &rhs) const {return order() >= rhs.order();}
+
+		/* *** BULK OPERATIONS *** */
+
+		/**
+		 * \brief Adds <tt>delta[i]</tt> to <tt>acc[i]</tt> for all <tt>count</tt> entries.
+		 *
+		 * The overflow check is branch-free, so the loop still vectorizes like one over plain <tt>long long</tt>s.
+		 */
+		static void add(FixedFraction* acc, const FixedFraction* delta, std::size_t count) {
+			for (std::size_t i = 0; i < count; ++i) {
+				acc[i].units = detail::fixed_add(acc[i].units, delta[i].units);
+			}
+		}
+
+		/**
+		 * @return The sum of <tt>count</tt> entries, without intermediate rounding.
+		 */
+		static FixedFraction sum(const FixedFraction* values, std::size_t count) {
+			long long signed int total = 0;
+			for (std::size_t i = 0; i < count; ++i) {
+				total = detail::fixed_add(total, values[i].units);
+			}
+			return from_units(total);
+		}
+	};
+
+	template <long long signed int Den>
+	constexpr long long signed int FixedFraction<Den>::denominator;
+}
+
+#endif //NPASSON_FIXED_FRACTION_HPP
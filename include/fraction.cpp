@@ -24,12 +24,17 @@
  * The code of the Fraction class.
  */
 
+#include <cmath>
+#include <limits>
 #include <sstream>
+#include <type_traits>
 
 #ifndef NPASSON_EXPERIMENTAL_COMPILE
 	#include "fraction.hpp"
 #endif
 
+#include "instrumentation.hpp"
+
 #ifdef NPASSON_DEBUG
 	#include <iostream>
 #endif
@@ -44,8 +49,49 @@
 // to include <climits> just for one value, especially in a library
 #define MAX_VAL 9223372036854775807
 
+// Fractions whose numerator and denominator are both below this are reduced by a table lookup instead of
+// Euclid's algorithm. The table takes NPASSON_GCD_TABLE_SIZE^2 bytes, two bytes per entry above 256: 64 KB for
+// the default of 256, which fits into L2, and 2 MB for the maximum of 1024, which only fits into L3 and misses
+// more often than Euclid's algorithm loses. Define NPASSON_NO_GCD_TABLE to leave it out entirely.
+#ifndef NPASSON_GCD_TABLE_SIZE
+#define NPASSON_GCD_TABLE_SIZE 256
+#endif
+
 namespace npasson {
 
+#ifndef NPASSON_NO_GCD_TABLE
+	namespace detail {
+
+		static_assert(NPASSON_GCD_TABLE_SIZE > 0 && NPASSON_GCD_TABLE_SIZE <= 1024,
+		              "Error: NPASSON_GCD_TABLE_SIZE must be between 1 and 1024");
+
+		typedef std::conditional<(NPASSON_GCD_TABLE_SIZE <= 256), unsigned char, unsigned short>::type gcd_table_entry;
+
+		/**
+		 * \brief The gcd of every pair of operands below <tt>NPASSON_GCD_TABLE_SIZE</tt>.
+		 *
+		 * Zero-initialized static storage, filled once by <tt>gcd_table_filler</tt> during static initialization,
+		 * so lookups need no guard. A Fraction constructed by an earlier static initializer may still read a zero
+		 * entry, which is never the gcd of the nonzero operands looked up, and falls back to Euclid's algorithm.
+		 */
+		gcd_table_entry gcd_table[NPASSON_GCD_TABLE_SIZE][NPASSON_GCD_TABLE_SIZE];
+
+		/**
+		 * Fills the table column by column, since <tt>gcd(a, b) = gcd(b, a % b)</tt> only refers to a lower column.
+		 */
+		struct GcdTableFiller {
+			GcdTableFiller() {
+				for (int b = 0; b < NPASSON_GCD_TABLE_SIZE; ++b) {
+					for (int a = 0; a < NPASSON_GCD_TABLE_SIZE; ++a) {
+						gcd_table[a][b] = static_cast<gcd_table_entry>((b == 0) ? a : gcd_table[b][a % b]);
+					}
+				}
+			}
+		};
+		const GcdTableFiller gcd_table_filler;
+	}
+#endif
+
 	/**
 	 * Tests if given char is a numeric digit. Compares it against the ASCII table digits.
 	 *
@@ -105,6 +151,7 @@ namespace npasson {
 	 * This constructor initializes the Fraction to be 0/1 (= 0)
 	 */
 	Fraction::Fraction() {
+		NPASSON_COUNT_SOURCE(default_value);
 		this->numerator = 0;
 		this->denominator = 1;
 	}
@@ -112,7 +159,9 @@ namespace npasson {
 	Fraction::Fraction(const Fraction&) = default;
 
 	Fraction::Fraction(long long signed int numerator, long long signed int denominator) {
+		NPASSON_COUNT_SOURCE(num_den);
 		if (denominator == 0) {
+			NPASSON_COUNT(invalid_created);
 			this->numerator = 0;
 			this->denominator = 1;
 			this->_invalid = true;
@@ -126,21 +175,39 @@ namespace npasson {
 			this->denominator = 1;
 			return;
 		}
-		short sign = 1;
-		if (numerator < 1) {
-			sign *= -1;
-			numerator *= -1;
+		bool negative = (numerator < 0) != (denominator < 0);
+		numerator = (numerator < 0) ? -numerator : numerator;
+		denominator = (denominator < 0) ? -denominator : denominator;
+		long long signed int divisor = 0;
+#ifndef NPASSON_NO_GCD_TABLE
+		if (numerator < NPASSON_GCD_TABLE_SIZE && denominator < NPASSON_GCD_TABLE_SIZE) {
+			// zero only before the table is filled
+			divisor = detail::gcd_table[numerator][denominator];
+			NPASSON_COUNT_IF(divisor != 0, gcd_table_lookups);
 		}
-		if (denominator < 1) {
-			sign *= -1;
-			denominator *= -1;
+		if (divisor == 0)
+#endif
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			if ((denominator & (denominator - 1)) == 0) {
+				// dyadic, e.g. from a double: the gcd is the lower of both powers of two
+				int shift = __builtin_ctzll(static_cast<unsigned long long int>(numerator | denominator));
+				NPASSON_COUNT(gcd_shifts);
+				NPASSON_COUNT_IF(shift != 0, normalizations);
+				this->numerator = negative ? -(numerator >> shift) : (numerator >> shift);
+				this->denominator = denominator >> shift;
+				return;
+			}
+#endif
+			divisor = Fraction::gcd(numerator, denominator);
 		}
-		long long signed int divisor = Fraction::gcd(numerator, denominator);
-		this->numerator = numerator/divisor*sign;
+		NPASSON_COUNT_IF(divisor != 1, normalizations);
+		this->numerator = negative ? -(numerator/divisor) : numerator/divisor;
 		this->denominator = denominator/divisor;
 	}
 
 	Fraction::Fraction(unsigned long long int numerator) {
+		NPASSON_COUNT_SOURCE(unsigned_long_long);
 		if(numerator < MAX_VAL) {
 			this->numerator = static_cast<long long int>(numerator);
 		}
@@ -150,22 +217,24 @@ namespace npasson {
 		}
 	}
 
-	Fraction::Fraction(signed long long int numerator) : numerator(numerator) {}
+	Fraction::Fraction(signed long long int numerator) : numerator(numerator) {NPASSON_COUNT_SOURCE(signed_long_long);}
 
-	Fraction::Fraction(unsigned long int numerator) : numerator(static_cast<long long signed int>(numerator)) {}
+	Fraction::Fraction(unsigned long int numerator) : numerator(static_cast<long long signed int>(numerator)) {NPASSON_COUNT_SOURCE(unsigned_long);}
 
-	Fraction::Fraction(signed long int numerator) : numerator(numerator) {}
+	Fraction::Fraction(signed long int numerator) : numerator(numerator) {NPASSON_COUNT_SOURCE(signed_long);}
 
-	Fraction::Fraction(unsigned int numerator) : numerator(static_cast<long long signed int>(numerator)) {}
+	Fraction::Fraction(unsigned int numerator) : numerator(static_cast<long long signed int>(numerator)) {NPASSON_COUNT_SOURCE(unsigned_int);}
 
-	Fraction::Fraction(signed int numerator) : numerator(numerator) {}
+	Fraction::Fraction(signed int numerator) : numerator(numerator) {NPASSON_COUNT_SOURCE(signed_int);}
 
-	Fraction::Fraction(unsigned short numerator) : numerator(static_cast<long long signed int>(numerator)) {}
+	Fraction::Fraction(unsigned short numerator) : numerator(static_cast<long long signed int>(numerator)) {NPASSON_COUNT_SOURCE(unsigned_short);}
 
-	Fraction::Fraction(signed short numerator) : numerator(numerator) {}
+	Fraction::Fraction(signed short numerator) : numerator(numerator) {NPASSON_COUNT_SOURCE(signed_short);}
 
 	Fraction::Fraction(std::string str_val) {
+		NPASSON_COUNT_SOURCE(std_string);
 		if(!isnumber(str_val)) {
+			NPASSON_COUNT(invalid_created);
 			this->numerator = 0;
 			this->denominator = 1;
 			this->_invalid = true;
@@ -203,11 +272,20 @@ namespace npasson {
 		this->denominator = final_frac.denominator;
 	}
 
-	Fraction::Fraction(float val) : Fraction(std::to_string(val)) {} // screw floating point, we'll do it via string
+	// these go through the string constructor, which counts as a construction from std::string as well
+	Fraction::Fraction(float val) : Fraction(std::to_string(val)) { // screw floating point, we'll do it via string
+		NPASSON_COUNT_SOURCE(single_float);
+		NPASSON_COUNT(string_conversions);
+	}
 
-	Fraction::Fraction(double val) : Fraction(std::to_string(val)) {} // cast it to string again I guess
+	Fraction::Fraction(double val) : Fraction(std::to_string(val)) { // cast it to string again I guess
+		NPASSON_COUNT_SOURCE(double_float);
+		NPASSON_COUNT(string_conversions);
+	}
 
 	Fraction::Fraction(long double val) {
+		NPASSON_COUNT_SOURCE(long_double);
+		NPASSON_COUNT(string_conversions);
 		std::stringstream tempss;
 		tempss << val;
 		Fraction temp (tempss.str());
@@ -215,9 +293,13 @@ namespace npasson {
 		this->denominator = temp.denominator;
 	} // why does std:: not have a long double constructor for string?
 
-	Fraction::Fraction(char* val) : Fraction(std::string(val)) {} // another cast, just like the other two times
+	Fraction::Fraction(char* val) : Fraction(std::string(val)) { // another cast, just like the other two times
+		NPASSON_COUNT_SOURCE(c_string);
+	}
 
-	Fraction::Fraction(const char* val) : Fraction(std::string(val)) {} // ...I will probably not accept merge requests about this
+	Fraction::Fraction(const char* val) : Fraction(std::string(val)) { // ...I will probably not accept merge requests about this
+		NPASSON_COUNT_SOURCE(c_string);
+	}
 
 	/**
 	 * This constructor has two effects:
@@ -231,9 +313,11 @@ namespace npasson {
 	 * @param valid A bool indicating if the Fraction should be valid.
 	 */
 	Fraction::Fraction(bool valid) {
+		NPASSON_COUNT_SOURCE(boolean);
 		if(valid) {
 			return;
 		} else {
+			NPASSON_COUNT(invalid_created);
 			this->_invalid = true;
 			this->denominator = 0;
 			this->numerator = 0;
@@ -253,12 +337,187 @@ namespace npasson {
 
 	/* === GENERIC RETURNS === */
 
-	Fraction::operator long long int()  const {return                     (numerator/           denominator);}
-	Fraction::operator long int()       const {return (long int)(((double) numerator)/(double)  denominator);}
-	Fraction::operator int()            const {return (int)     (((double) numerator)/(double)  denominator);}
-	Fraction::operator short()          const {return (short)   (((double) numerator)/(double)  denominator);}
-	Fraction::operator float()          const {return (float)   (((double) numerator)/(double)  denominator);}
-	Fraction::operator double()         const {return            ((double) numerator)/(double)  denominator;}
+	/**
+	 * \brief Returns <tt>num/den</tt> correctly rounded to the floating point type <tt>T</tt>.
+	 *
+	 * If both operands fit into the mantissa of <tt>T</tt> they are exactly representable, so a single hardware
+	 * division is already correctly rounded to nearest; the directed modes fix it up with the exact remainder that
+	 * <tt>fma</tt> yields. Otherwise the quotient is computed in integers with two guard bits and a sticky bit and
+	 * rounded by hand. The result can never be subnormal or overflow since <tt>|num/den|</tt> lies within
+	 * <tt>[2^-63, 2^63]</tt>.
+	 *
+	 * @tparam T <tt>float</tt> or <tt>double</tt>.
+	 * @param num The numerator.
+	 * @param den The denominator. Zero yields NaN.
+	 * @param mode The rounding direction.
+	 * @return The rounded quotient.
+	 */
+	template <typename T>
+	T Fraction::quotient(long long signed int num, long long signed int den, RoundingMode mode) {
+		if (den == 0) return std::numeric_limits<T>::quiet_NaN();
+		if (num == 0) return T(0);
+
+		const int digits = std::numeric_limits<T>::digits;
+		bool neg = (num < 0) != (den < 0);
+		// negate in unsigned so that the most negative value survives
+		unsigned long long int n = (num < 0) ? 0ull - static_cast<unsigned long long int>(num) : static_cast<unsigned long long int>(num);
+		unsigned long long int d = (den < 0) ? 0ull - static_cast<unsigned long long int>(den) : static_cast<unsigned long long int>(den);
+
+		// rounding on the magnitude: away from zero, toward zero or to nearest
+		bool away = (mode == RoundingMode::upward && !neg) || (mode == RoundingMode::downward && neg);
+		bool trunc = !away && mode != RoundingMode::to_nearest;
+
+		if ((n >> digits) == 0 && (d >> digits) == 0) {
+			T a = static_cast<T>(n);
+			T b = static_cast<T>(d);
+			T q = a / b;
+			if (away || trunc) {
+				T r = std::fma(-q, b, a); // exact: a - q*b
+				if (away && r > 0) q = std::nextafter(q, std::numeric_limits<T>::infinity());
+				if (trunc && r < 0) q = std::nextafter(q, T(0));
+			}
+			return neg ? -q : q;
+		}
+
+		auto bitlen = [](unsigned long long int x) {
+#if defined(__GNUC__) || defined(__clang__)
+			return x ? 64 - __builtin_clzll(x) : 0;
+#else
+			int len = 0;
+			while (x) { x >>= 1; ++len; }
+			return len;
+#endif
+		};
+
+		// q * 2^exp is the truncated quotient with at least digits+2 significant bits
+		const int precision = digits + 2;
+		unsigned long long int q;
+		bool sticky;
+		int exp;
+		int shift = precision + bitlen(d) - bitlen(n);
+		if (shift <= 0) {
+			q = n / d;
+			sticky = (n % d) != 0;
+			exp = 0;
+		} else {
+#if defined(__SIZEOF_INT128__)
+			// n << shift has precision + bitlen(d) <= 119 bits
+			unsigned __int128 wide = static_cast<unsigned __int128>(n) << shift;
+			q = static_cast<unsigned long long int>(wide / d);
+			sticky = (wide % d) != 0;
+			exp = -shift;
+#else
+			// schoolbook long division, one quotient bit per step; r < d <= 2^63 so r << 1 never overflows
+			unsigned long long int r = n % d;
+			q = n / d;
+			exp = 0;
+			while (bitlen(q) < precision) {
+				r <<= 1;
+				q <<= 1;
+				if (r >= d) {
+					r -= d;
+					q |= 1;
+				}
+				--exp;
+			}
+			sticky = r != 0;
+#endif
+		}
+
+		int drop = bitlen(q) - digits;
+		unsigned long long int mantissa = q >> drop;
+		unsigned long long int rest = q & ((1ull << drop) - 1);
+		unsigned long long int half = 1ull << (drop - 1);
+		bool inexact = rest != 0 || sticky;
+		if (away) {
+			mantissa += inexact ? 1 : 0;
+		} else if (!trunc) {
+			mantissa += (rest > half || (rest == half && (sticky || (mantissa & 1)))) ? 1 : 0;
+		}
+
+		T result = std::ldexp(static_cast<T>(mantissa), drop + exp);
+		return neg ? -result : result;
+	}
+
+	/**
+	 * \brief Converts the Fraction to the nearest <tt>double</tt> in the given direction.
+	 *
+	 * Unlike dividing the casted numerator by the casted denominator, this rounds only once and is exact for
+	 * numerators and denominators beyond 2^53. Invalid Fractions yield NaN.
+	 *
+	 * @param mode The rounding direction, to nearest (ties to even) by default.
+	 * @return <tt>this</tt> as a correctly rounded <tt>double</tt>.
+	 */
+	double Fraction::to_double(RoundingMode mode) const {
+		NPASSON_TIME(to_double);
+		if (_invalid) return std::numeric_limits<double>::quiet_NaN();
+		return quotient<double>(numerator, denominator, mode);
+	}
+
+	/**
+	 * \brief Converts the Fraction to the nearest <tt>float</tt> in the given direction.
+	 *
+	 * Rounds directly to <tt>float</tt> instead of going through <tt>double</tt>, which could round twice.
+	 * Invalid Fractions yield NaN.
+	 *
+	 * @param mode The rounding direction, to nearest (ties to even) by default.
+	 * @return <tt>this</tt> as a correctly rounded <tt>float</tt>.
+	 */
+	float Fraction::to_float(RoundingMode mode) const {
+		if (_invalid) return std::numeric_limits<float>::quiet_NaN();
+		return quotient<float>(numerator, denominator, mode);
+	}
+
+	/**
+	 * Converts <tt>count</tt> Fractions from <tt>in</tt> to <tt>double</tt>s in <tt>out</tt>.
+	 *
+	 * @param in The Fractions to convert.
+	 * @param out Storage for at least <tt>count</tt> results.
+	 * @param count The number of Fractions.
+	 * @param mode The rounding direction.
+	 * \sa to_double(RoundingMode)
+	 */
+	NPASSON_MAYBE_UNUSED void Fraction::to_double(const Fraction* in, double* out, std::size_t count, RoundingMode mode) {
+		for (std::size_t i = 0; i < count; ++i) {
+			out[i] = in[i].to_double(mode);
+		}
+	}
+
+	/**
+	 * Converts <tt>count</tt> Fractions from <tt>in</tt> to <tt>float</tt>s in <tt>out</tt>.
+	 *
+	 * @param in The Fractions to convert.
+	 * @param out Storage for at least <tt>count</tt> results.
+	 * @param count The number of Fractions.
+	 * @param mode The rounding direction.
+	 * \sa to_float(RoundingMode)
+	 */
+	NPASSON_MAYBE_UNUSED void Fraction::to_float(const Fraction* in, float* out, std::size_t count, RoundingMode mode) {
+		for (std::size_t i = 0; i < count; ++i) {
+			out[i] = in[i].to_float(mode);
+		}
+	}
+
+	namespace detail {
+		/**
+		 * <tt>num / den</tt> truncated toward zero like the built-in casts, without a detour through double. Invalid
+		 * Fractions have no integer value and yield 0 instead of dividing by their zero denominator; the one
+		 * quotient beyond the range, <tt>LLONG_MIN / -1</tt> after <tt>invert(Fraction&)</tt>, saturates.
+		 */
+		inline long long signed int truncated(long long signed int num, long long signed int den, bool invalid) {
+			if (invalid || den == 0) return 0;
+			if (den == -1) return (num == std::numeric_limits<long long signed int>::min())
+			                      ? std::numeric_limits<long long signed int>::max() : -num;
+			return num / den;
+		}
+	}
+
+	Fraction::operator long long int()  const {return                     detail::truncated(numerator, denominator, _invalid);}
+	Fraction::operator long int()       const {return (long int)          detail::truncated(numerator, denominator, _invalid);}
+	Fraction::operator int()            const {return (int)               detail::truncated(numerator, denominator, _invalid);}
+	Fraction::operator short()          const {return (short)             detail::truncated(numerator, denominator, _invalid);}
+	Fraction::operator float()          const {return to_float();}
+	Fraction::operator double()         const {return to_double();}
 	Fraction::operator bool()           const {return                     (numerator != 0);}
 
 	/**
@@ -267,6 +526,7 @@ namespace npasson {
 	 * @return <tt>this</tt> as a <tt>std::string</tt>.
 	 */
 	std::string Fraction::str() const {
+		NPASSON_TIME(str);
 		return std::to_string((double)(*this));
 	}
 
@@ -285,6 +545,7 @@ namespace npasson {
 	 * @return <tt>this</tt> as a <tt>std::string</tt>.
 	 */
 	NPASSON_MAYBE_UNUSED std::string Fraction::f_str() const {
+		NPASSON_TIME(f_str);
 		return (std::to_string((*this).numerator) + "/" + std::to_string((*this).denominator));
 	}
 
@@ -292,6 +553,10 @@ namespace npasson {
 
 	/* **** PLUS **** */
 	Fraction& Fraction::operator+=(const Fraction &rhs) {
+		NPASSON_TIME(add);
+		NPASSON_COUNT_IF(_invalid || rhs._invalid, invalid_operands);
+		NPASSON_COUNT_IF(detail::sum_of_products_overflows(numerator, rhs.denominator, rhs.numerator, denominator, false)
+		                 || detail::product_overflows(denominator, rhs.denominator), overflows);
 		long long int num, den;
 		num = (numerator*rhs.denominator + rhs.numerator*denominator);
 		den = denominator*rhs.denominator;
@@ -305,6 +570,10 @@ namespace npasson {
 
 	/* **** MINUS **** */
 	Fraction& Fraction::operator-=(const Fraction &rhs) {
+		NPASSON_TIME(sub);
+		NPASSON_COUNT_IF(_invalid || rhs._invalid, invalid_operands);
+		NPASSON_COUNT_IF(detail::sum_of_products_overflows(numerator, rhs.denominator, rhs.numerator, denominator, true)
+		                 || detail::product_overflows(denominator, rhs.denominator), overflows);
 		long long int num, den;
 		num = (numerator*rhs.denominator - rhs.numerator*denominator);
 		den = denominator*rhs.denominator;
@@ -319,6 +588,10 @@ namespace npasson {
 
 	/* MULTIPLICATION */
 	Fraction& Fraction::operator*=(const Fraction &rhs) {
+		NPASSON_TIME(mul);
+		NPASSON_COUNT_IF(_invalid || rhs._invalid, invalid_operands);
+		NPASSON_COUNT_IF(detail::product_overflows(numerator, rhs.numerator)
+		                 || detail::product_overflows(denominator, rhs.denominator), overflows);
 		return ((*this) = Fraction(
 			numerator * rhs.numerator,
 			denominator * rhs.denominator
@@ -332,6 +605,10 @@ namespace npasson {
 
 	/* DIVISION */
 	Fraction& Fraction::operator/=(const Fraction &rhs) {
+		NPASSON_TIME(div);
+		NPASSON_COUNT_IF(_invalid || rhs._invalid, invalid_operands);
+		NPASSON_COUNT_IF(detail::product_overflows(numerator, rhs.denominator)
+		                 || detail::product_overflows(denominator, rhs.numerator), overflows);
 		return ((*this) = Fraction(
 			numerator * rhs.denominator,
 			denominator * rhs.numerator
@@ -356,7 +633,38 @@ namespace npasson {
 	std::ostream&         operator<<(std::ostream &os, const Fraction &frac) {os << (double)frac; return os;}
 	std::string	Fraction::operator()(){return this->str();}
 
+	/**
+	 * \brief Returns a hash of the reduced numerator and denominator.
+	 *
+	 * Every constructor reduces, so unlike <tt>operator==</tt> this needs no gcd; only the sign is moved to the
+	 * numerator. Both parts are run through the splitmix64 finalizer, which spreads consecutive values over all
+	 * bits and so suits open addressing with power of two tables.
+	 *
+	 * @return The hash value.
+	 */
+	std::size_t Fraction::hash() const {
+		auto mix = [](unsigned long long int x) {
+			x ^= x >> 30;
+			x *= 0xBF58476D1CE4E5B9ull;
+			x ^= x >> 27;
+			x *= 0x94D049BB133111EBull;
+			x ^= x >> 31;
+			return x;
+		};
+		// invert(Fraction&) may leave a negative denominator behind
+		// negated in unsigned, where the most negative value wraps instead of overflowing
+		unsigned long long int num = static_cast<unsigned long long int>(numerator);
+		unsigned long long int den = static_cast<unsigned long long int>(denominator);
+		if (denominator < 0) {
+			num = 0ull - num;
+			den = 0ull - den;
+		}
+		return static_cast<std::size_t>(mix(num + 0x9E3779B97F4A7C15ull * mix(den)));
+	}
+
 	bool Fraction::operator==(const Fraction &rhs) const {
+		NPASSON_TIME(equal);
+		NPASSON_COUNT_IF(_invalid || rhs._invalid, invalid_operands);
 		return ((this->numerator == 0)? rhs.numerator == 0 :
 			(
 			      (this->numerator/gcd(this->numerator, this->denominator)
@@ -370,14 +678,22 @@ namespace npasson {
 	}
 
 	bool Fraction::operator< (const Fraction &rhs) const {
+		NPASSON_TIME(less);
+		NPASSON_COUNT_IF(_invalid || rhs._invalid, invalid_operands);
 		long long int multiple = lcm(denominator, rhs.denominator);
+		NPASSON_COUNT_IF(detail::product_overflows(numerator, multiple/denominator)
+		                 || detail::product_overflows(rhs.numerator, multiple/rhs.denominator), overflows);
 		return (
 			  (this->numerator)*(multiple/this->denominator)
 			< (rhs.  numerator)*(multiple/rhs.  denominator)
 		);
 	}
 	bool Fraction::operator> (const Fraction &rhs) const {
+		NPASSON_TIME(greater);
+		NPASSON_COUNT_IF(_invalid || rhs._invalid, invalid_operands);
 		long long int multiple = lcm(denominator, rhs.denominator);
+		NPASSON_COUNT_IF(detail::product_overflows(numerator, multiple/denominator)
+		                 || detail::product_overflows(rhs.numerator, multiple/rhs.denominator), overflows);
 		return (
 			  (this->numerator)*(multiple/this->denominator)
 			> (rhs.  numerator)*(multiple/rhs.  denominator)
@@ -386,6 +702,116 @@ namespace npasson {
 	bool Fraction::operator<=(const Fraction &rhs) const {return !((*this)>rhs);}
 	bool Fraction::operator>=(const Fraction &rhs) const {return !((*this)<rhs);}
 
+	/**
+	 * \brief Three-way compares two Fractions.
+	 *
+	 * Cross-multiplies in 128 bits where available, so unlike the lcm in <tt>operator<</tt> nothing can overflow.
+	 * Invalid Fractions are ordered after all valid ones and equal to each other, so this is a strict weak ordering
+	 * even with invalid values in a sorted range.
+	 *
+	 * @param rhs The Fraction to compare against.
+	 * @return <tt>-1</tt>, <tt>0</tt> or <tt>1</tt> if <tt>this</tt> is less than, equal to or greater than <tt>rhs</tt>.
+	 */
+	int Fraction::compare(const Fraction &rhs) const {
+		NPASSON_TIME(compare);
+		NPASSON_COUNT_IF(_invalid || rhs._invalid, invalid_operands);
+		if (_invalid || rhs._invalid) return static_cast<int>(_invalid) - static_cast<int>(rhs._invalid);
+#if defined(__SIZEOF_INT128__)
+		__int128 lhs_cross = static_cast<__int128>(numerator) * rhs.denominator;
+		__int128 rhs_cross = static_cast<__int128>(rhs.numerator) * denominator;
+		int result = (lhs_cross > rhs_cross) - (lhs_cross < rhs_cross);
+		// invert(Fraction&) may leave a negative denominator behind
+		return ((denominator < 0) != (rhs.denominator < 0)) ? -result : result;
+#else
+		auto magnitude = [](long long signed int x) {
+			return (x < 0) ? 0ull - static_cast<unsigned long long int>(x) : static_cast<unsigned long long int>(x);
+		};
+		// full 64x64 bit product as a (high, low) pair, from 32 bit halves
+		auto multiply = [](unsigned long long int a, unsigned long long int b, unsigned long long int &high, unsigned long long int &low) {
+			unsigned long long int a_lo = a & 0xFFFFFFFFull, a_hi = a >> 32;
+			unsigned long long int b_lo = b & 0xFFFFFFFFull, b_hi = b >> 32;
+			unsigned long long int lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi;
+			unsigned long long int middle = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFull) + (lo_hi & 0xFFFFFFFFull);
+			high = a_hi * b_hi + (hi_lo >> 32) + (lo_hi >> 32) + (middle >> 32);
+			low = (middle << 32) | (lo_lo & 0xFFFFFFFFull);
+		};
+
+		int lhs_sign = ((numerator > 0) - (numerator < 0)) * ((denominator < 0) ? -1 : 1);
+		int rhs_sign = ((rhs.numerator > 0) - (rhs.numerator < 0)) * ((rhs.denominator < 0) ? -1 : 1);
+		if (lhs_sign != rhs_sign) return (lhs_sign > rhs_sign) ? 1 : -1;
+		if (lhs_sign == 0) return 0;
+
+		unsigned long long int lhs_high, lhs_low, rhs_high, rhs_low;
+		multiply(magnitude(numerator), magnitude(rhs.denominator), lhs_high, lhs_low);
+		multiply(magnitude(rhs.numerator), magnitude(denominator), rhs_high, rhs_low);
+		int result = (lhs_high != rhs_high) ? ((lhs_high > rhs_high) ? 1 : -1) : (lhs_low > rhs_low) - (lhs_low < rhs_low);
+		return lhs_sign * result;
+#endif
+	}
+
+	/**
+	 * \brief Compares the Fraction exactly against a floating point value.
+	 *
+	 * No Fraction is constructed from <tt>rhs</tt>, so there is neither a string round trip nor the six digit
+	 * rounding of <tt>std::to_string</tt>. A plain floating point division decides almost every comparison; only
+	 * if <tt>rhs</tt> lies within the error bound of that division, the Fraction is bracketed between its two
+	 * directed roundings, which are equal exactly when it is representable.
+	 *
+	 * @param rhs Any <tt>double</tt> (<tt>float</tt>s convert exactly).
+	 * @retval <b><tt>-1</tt></b> if <tt>this</tt> is less than <tt>rhs</tt>
+	 * @retval <b><tt>0</tt></b> if they are equal
+	 * @retval <b><tt>1</tt></b> if <tt>this</tt> is greater than <tt>rhs</tt>
+	 * @retval <b><tt>2</tt></b> if they are unordered, i.e. <tt>rhs</tt> is NaN or the Fraction is invalid
+	 */
+	int Fraction::compare(double rhs) const {
+		NPASSON_TIME(compare_double);
+		NPASSON_COUNT_IF(_invalid, invalid_operands);
+		if (_invalid || rhs != rhs) return 2;
+
+		// three roundings, each off by at most 2^-53 relatively; 2^-50 leaves room for computing the bounds
+		double approx = (double)numerator / (double)denominator;
+		double slack = std::fabs(approx) * 8.8817841970012523e-16; // 2^-50
+		if (rhs < approx - slack) return 1;
+		if (rhs > approx + slack) return -1;
+
+		double lower = quotient<double>(numerator, denominator, RoundingMode::downward);
+		double upper = quotient<double>(numerator, denominator, RoundingMode::upward);
+		if (rhs < lower) return 1;
+		if (rhs > upper) return -1;
+		if (lower == upper) return 0;
+		// lower and upper are neighbours with the Fraction strictly between them, and rhs is one of them
+		return (rhs == lower) ? 1 : -1;
+	}
+
+	/**
+	 * \brief Compares <tt>count</tt> Fractions against the same floating point value.
+	 *
+	 * Runs the floating point filter over the whole array first, so that loop stays branch-light and can be
+	 * vectorized, then resolves the few undecided entries exactly.
+	 *
+	 * @param in The Fractions to compare.
+	 * @param count The number of Fractions.
+	 * @param rhs The value to compare against.
+	 * @param out Storage for at least <tt>count</tt> results, each as returned by <tt>compare(double)</tt>.
+	 * \sa compare(double)
+	 */
+	NPASSON_MAYBE_UNUSED void Fraction::compare(const Fraction* in, std::size_t count, double rhs, signed char* out) {
+		if (rhs != rhs) {
+			for (std::size_t i = 0; i < count; ++i) out[i] = 2;
+			return;
+		}
+
+		for (std::size_t i = 0; i < count; ++i) {
+			double approx = (double)in[i].numerator / (double)in[i].denominator;
+			double slack = std::fabs(approx) * 8.8817841970012523e-16; // 2^-50
+			out[i] = (signed char)((rhs < approx - slack) - (rhs > approx + slack));
+		}
+
+		for (std::size_t i = 0; i < count; ++i) {
+			if (out[i] == 0 || in[i]._invalid) out[i] = (signed char)in[i].compare(rhs);
+		}
+	}
+
 	/* non-atomic OPERATORS */
 
 	/**
@@ -398,6 +824,7 @@ namespace npasson {
 	 * @return
 	 */
 	Fraction Fraction::pow(signed int exp) {
+		NPASSON_TIME(pow);
 		if (exp == 0) return Fraction(1);
 		if(exp<0) return (this->invert()).pow(-exp);
 		exp = (exp<0)?(-exp):(exp);
@@ -469,12 +896,16 @@ namespace npasson {
 	 * @return The GCD of a and b.
 	 */
 	long long signed int Fraction::gcd(long long signed int a, long long signed int b) {
+		NPASSON_COUNT(gcd_calls);
 		long long signed int t;
+		unsigned long long int iterations = 0;
 		while (b!=0) {
+			++iterations;
 			t = b;
 			b = a%b;
 			a = t;
 		}
+		NPASSON_COUNT_ADD(gcd_iterations, iterations);
 		return a;
 	}
 
@@ -490,7 +921,9 @@ namespace npasson {
 	 * @return The LCM of a and b.
 	 */
 	long long signed int Fraction::lcm(long long signed int a, long long signed int b) {
-		return (abs(a) / gcd(a, b)) * abs(b);
+		long long signed int reduced = abs(a) / gcd(a, b);
+		NPASSON_COUNT_IF(detail::product_overflows(reduced, abs(b)), overflows);
+		return reduced * abs(b);
 	}
 
 }
@@ -39,7 +39,10 @@
 #define NPASSON_MAYBE_UNUSED
 #endif
 
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <type_traits>
 #include <typeinfo>
 
 #ifdef NPASSON_DEBUG
@@ -51,6 +54,17 @@
 
 namespace npasson {
 
+	/**
+	 * Rounding modes for conversions that cannot be exact. The names follow the IEEE 754 rounding-direction
+	 * attributes; <tt>to_nearest</tt> breaks ties to even.
+	 */
+	enum class RoundingMode {
+		to_nearest,
+		toward_zero,
+		upward,
+		downward
+	};
+
 	/**
 	 *  The Fraction type. Read more at npasson.com/fractiontype
 	 */
@@ -65,6 +79,8 @@ namespace npasson {
 		constexpr static bool isdigit(char);
 		constexpr static bool isdelim(char);
 		          static bool isnumber(std::string);
+		template <typename T>
+		          static T quotient(long long signed int, long long signed int, RoundingMode);
 	public:
 		/**
 		 * @tparam T A numeric type which might be supported.
@@ -106,6 +122,8 @@ namespace npasson {
 		~Fraction();
 
 		NPASSON_MAYBE_UNUSED bool valid() const;
+		long long signed int num() const {return numerator;}
+		long long signed int den() const {return denominator;}
 
 		explicit operator long long int() const;
 		explicit operator long int() const;
@@ -114,6 +132,10 @@ namespace npasson {
 		explicit operator float() const;
 		explicit operator double() const;
 		explicit operator bool () const;
+		double to_double(RoundingMode = RoundingMode::to_nearest) const;
+		float  to_float (RoundingMode = RoundingMode::to_nearest) const;
+		NPASSON_MAYBE_UNUSED static void to_double(const Fraction*, double*, std::size_t, RoundingMode = RoundingMode::to_nearest);
+		NPASSON_MAYBE_UNUSED static void to_float (const Fraction*, float*,  std::size_t, RoundingMode = RoundingMode::to_nearest);
 		std::string str() const;
 		NPASSON_MAYBE_UNUSED const char* c_str() const;
 		NPASSON_MAYBE_UNUSED std::string f_str() const;
@@ -281,46 +303,84 @@ namespace npasson {
 		bool operator<=(const Fraction&) const;
 		bool operator>=(const Fraction&) const;
 
+		int compare(const Fraction&) const;
+		int compare(double) const;
+		NPASSON_MAYBE_UNUSED static void compare(const Fraction*, std::size_t, double, signed char*);
+
+		// floating point operands are compared exactly through compare(double), everything else via Fraction(rhs)
+
 		template <typename T>
 		bool operator==(const T &rhs) const {
 			static_assert(Fraction::is_supported_type<T>(), "Error: unsupported type for operator == (Fraction, [type])");
+			NPASSON_IF_CONSTEXPR (std::is_floating_point<T>::value) {
+				int c = compare(static_cast<double>(rhs));
+				return c == 0;
+			}
 			return (*this) == Fraction(rhs);
 		}
 
 		template <typename T>
 		bool operator!=(const T &rhs) const {
 			static_assert(Fraction::is_supported_type<T>(), "Error: unsupported type for operator != (Fraction, [type])");
+			NPASSON_IF_CONSTEXPR (std::is_floating_point<T>::value) {
+				int c = compare(static_cast<double>(rhs));
+				return c != 0;
+			}
 			return (*this) != Fraction(rhs);
 		}
 
 		template <typename T>
 		bool operator<(const T &rhs) const {
 			static_assert(Fraction::is_supported_type<T>(), "Error: unsupported type for operator < (Fraction, [type])");
+			NPASSON_IF_CONSTEXPR (std::is_floating_point<T>::value) {
+				int c = compare(static_cast<double>(rhs));
+				return c == -1;
+			}
 			return (*this) < Fraction(rhs);
 		}
 
 		template <typename T>
 		bool operator>(const T &rhs) const {
 			static_assert(Fraction::is_supported_type<T>(), "Error: unsupported type for operator > (Fraction, [type])");
+			NPASSON_IF_CONSTEXPR (std::is_floating_point<T>::value) {
+				int c = compare(static_cast<double>(rhs));
+				return c == 1;
+			}
 			return (*this) > Fraction(rhs);
 		}
 
 		template <typename T>
 		bool operator<=(const T &rhs) const {
 			static_assert(Fraction::is_supported_type<T>(), "Error: unsupported type for operator <= (Fraction, [type])");
+			NPASSON_IF_CONSTEXPR (std::is_floating_point<T>::value) {
+				int c = compare(static_cast<double>(rhs));
+				return c == -1 || c == 0;
+			}
 			return (*this) <= Fraction(rhs);
 		}
 
 		template <typename T>
 		bool operator>=(const T &rhs) const {
 			static_assert(Fraction::is_supported_type<T>(), "Error: unsupported type for operator >= (Fraction, [type])");
+			NPASSON_IF_CONSTEXPR (std::is_floating_point<T>::value) {
+				int c = compare(static_cast<double>(rhs));
+				return c == 1 || c == 0;
+			}
 			return (*this) >= Fraction(rhs);
 		}
 
 		/* *** OTHER OPERATORS *** */
 
-		//TODO root()
 		Fraction pow(signed int);
+		Fraction root(unsigned int, long long signed int = 9223372036854775807ll) const;
+		Fraction root(unsigned int, const Fraction&) const;
+		Fraction sqrt(long long signed int = 9223372036854775807ll) const;
+		Fraction sqrt(const Fraction&) const;
+		// a floating point tolerance would silently convert to a maximum denominator
+		template <typename T, typename = typename std::enable_if<std::is_floating_point<T>::value>::type>
+		Fraction root(unsigned int, T) const = delete;
+		template <typename T, typename = typename std::enable_if<std::is_floating_point<T>::value>::type>
+		Fraction sqrt(T) const = delete;
 
 		Fraction invert() const;
 		NPASSON_MAYBE_UNUSED static void invert(Fraction&);
@@ -328,6 +388,8 @@ namespace npasson {
 		friend std::ostream& operator << (std::ostream&, const Fraction&);
 		std::string operator()();
 
+		std::size_t hash() const;
+
 #ifdef NPASSON_DEBUG
 		template<typename T, typename U>
 		static void test (T& a, U& b) {
@@ -488,45 +550,56 @@ namespace npasson {
 	template <typename T>
 	bool operator==(const T &lhs, const Fraction &rhs) {
 		static_assert(Fraction::is_supported_type<T>(), "Error: unsupported type for operator == (Fraction, [type])");
-		return rhs == Fraction(lhs);
+		return rhs == lhs;
 	}
 
 	template <typename T>
 	bool operator!=(const T &lhs, const Fraction &rhs) {
 		static_assert(Fraction::is_supported_type<T>(), "Error: unsupported type for operator != (Fraction, [type])");
-		return rhs != Fraction(lhs);
+		return rhs != lhs;
 	}
 
 	template <typename T>
 	bool operator<(const T &lhs, const Fraction &rhs) {
 		static_assert(Fraction::is_supported_type<T>(), "Error: unsupported type for operator < (Fraction, [type])");
-		return Fraction(lhs) < rhs;
+		return rhs > lhs;
 	}
 
 	template <typename T>
 	bool operator>(const T &lhs, const Fraction &rhs) {
 		static_assert(Fraction::is_supported_type<T>(), "Error: unsupported type for operator > (Fraction, [type])");
-		return Fraction(lhs) > rhs;
+		return rhs < lhs;
 	}
 
 	template <typename T>
 	bool operator<=(const T &lhs, const Fraction &rhs) {
 		static_assert(Fraction::is_supported_type<T>(), "Error: unsupported type for operator <= (Fraction, [type])");
-		return Fraction(lhs) <= rhs;
+		return rhs >= lhs;
 	}
 
 	template <typename T>
 	bool operator>=(const T &lhs, const Fraction &rhs) {
 		static_assert(Fraction::is_supported_type<T>(), "Error: unsupported type for operator >= (Fraction, [type])");
-		return Fraction(lhs) >= rhs;
+		return rhs <= lhs;
 	}
 }
 
+namespace std {
+	/**
+	 * Hashes a Fraction by its reduced form, so Fractions that compare equal hash equally.
+	 */
+	template <>
+	struct hash<npasson::Fraction> {
+		std::size_t operator()(const npasson::Fraction &frac) const {return frac.hash();}
+	};
+}
+
 #undef NPASSON_MAYBE_UNUSED
 #undef NPASSON_IF_CONSTEXPR
 
 #ifdef NPASSON_EXPERIMENTAL_COMPILE
 #include "fraction.cpp"
+#include "fraction_root.cpp"
 #endif
 
 #endif //NPASSON_FRACTION_HPP
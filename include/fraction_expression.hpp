@@ -0,0 +1,308 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file fraction_expression.hpp
+ * Contains FractionExpression, expression templates that evaluate Fraction arithmetic with a single reduction.
+ */
+
+#ifndef NPASSON_FRACTION_EXPRESSION_HPP
+#define NPASSON_FRACTION_EXPRESSION_HPP
+
+#include <type_traits>
+
+#include "checked_arithmetic.hpp"
+#include "fraction.hpp"
+
+namespace npasson {
+
+	namespace detail {
+
+		/**
+		 * An intermediate result <tt>n/d</tt> with <tt>d > 0</tt> that has not been reduced.
+		 */
+		struct Unreduced {
+			long long signed int n;
+			long long signed int d;
+			bool invalid;
+		};
+
+		/**
+		 * The gcd of two values within <tt>±checked_limit</tt>, of which <tt>b</tt> is nonzero.
+		 */
+		inline long long signed int expression_gcd(long long signed int a, long long signed int b) {
+			a = (a < 0) ? -a : a;
+			b = (b < 0) ? -b : b;
+			long long signed int t;
+			while (b != 0) {
+				t = b;
+				b = a % b;
+				a = t;
+			}
+			return a;
+		}
+
+		inline Unreduced reduced(Unreduced x) {
+			long long signed int divisor = expression_gcd(x.n, x.d);
+			if (divisor > 1) {
+				x.n /= divisor;
+				x.d /= divisor;
+			}
+			return x;
+		}
+
+		/**
+		 * <tt>a + b</tt>, or <tt>a - b</tt> if <tt>subtract</tt> is set. Equal denominators are kept as they are;
+		 * otherwise the denominators are multiplied, and only if that overflows both sides are reduced and brought
+		 * to their least common denominator instead.
+		 */
+		inline Unreduced add(const Unreduced &a, const Unreduced &b, bool subtract) {
+			Unreduced result = {0, 1, a.invalid || b.invalid};
+			if (result.invalid) return result;
+
+			long long signed int lhs, rhs;
+			if (a.d == b.d) {
+				result.d = a.d;
+				if (subtract ? checked_sub(a.n, b.n, &result.n) : checked_add(a.n, b.n, &result.n)) {
+					return result;
+				}
+			} else if (checked_mul(a.n, b.d, &lhs) && checked_mul(b.n, a.d, &rhs)
+			        && checked_mul(a.d, b.d, &result.d)
+			        && (subtract ? checked_sub(lhs, rhs, &result.n) : checked_add(lhs, rhs, &result.n))) {
+				return result;
+			}
+
+			Unreduced x = reduced(a);
+			Unreduced y = reduced(b);
+			long long signed int divisor = expression_gcd(x.d, y.d);
+#if defined(__SIZEOF_INT128__)
+			// the sum may share factors with the denominator that only show after adding, so add in 128 bits
+			__int128 wide_lhs = static_cast<__int128>(x.n) * (y.d / divisor);
+			__int128 wide_rhs = static_cast<__int128>(y.n) * (x.d / divisor);
+			__int128 wide_n;
+			if ((subtract ? checked_sub(wide_lhs, wide_rhs, &wide_n) : checked_add(wide_lhs, wide_rhs, &wide_n))
+			 && narrow(wide_n, static_cast<__int128>(x.d / divisor) * y.d, result.n, result.d)) {
+				return result;
+			}
+#else
+			if (checked_mul(x.n, y.d / divisor, &lhs) && checked_mul(y.n, x.d / divisor, &rhs)
+			 && checked_mul(x.d / divisor, y.d, &result.d)
+			 && (subtract ? checked_sub(lhs, rhs, &result.n) : checked_add(lhs, rhs, &result.n))) {
+				return result;
+			}
+#endif
+			result.invalid = true;
+			return result;
+		}
+
+		/**
+		 * <tt>a * b</tt>. The cross gcds <tt>gcd(a.n, b.d)</tt> and <tt>gcd(b.n, a.d)</tt> are only taken if the
+		 * plain products overflow.
+		 */
+		inline Unreduced multiply(const Unreduced &a, const Unreduced &b) {
+			Unreduced result = {0, 1, a.invalid || b.invalid};
+			if (result.invalid) return result;
+
+			if (checked_mul(a.n, b.n, &result.n) && checked_mul(a.d, b.d, &result.d)) {
+				return result;
+			}
+
+			long long signed int g1 = expression_gcd(a.n, b.d);
+			long long signed int g2 = expression_gcd(b.n, a.d);
+			g1 = g1 ? g1 : 1;
+			g2 = g2 ? g2 : 1;
+			if (checked_mul(a.n / g1, b.n / g2, &result.n) && checked_mul(a.d / g2, b.d / g1, &result.d)) {
+				return result;
+			}
+#if defined(__SIZEOF_INT128__)
+			// unreduced operands may still share factors within themselves
+			if (narrow(static_cast<__int128>(a.n / g1) * (b.n / g2), static_cast<__int128>(a.d / g2) * (b.d / g1),
+			           result.n, result.d)) {
+				return result;
+			}
+#endif
+			result.invalid = true;
+			return result;
+		}
+
+		inline Unreduced reciprocal(const Unreduced &a) {
+			Unreduced result = {a.d, a.n, a.invalid || a.n == 0};
+			if (result.d < 0) {
+				result.n = -result.n;
+				result.d = -result.d;
+			}
+			return result;
+		}
+
+		struct Plus       {static Unreduced apply(const Unreduced &a, const Unreduced &b) {return add(a, b, false);}};
+		struct Minus      {static Unreduced apply(const Unreduced &a, const Unreduced &b) {return add(a, b, true);}};
+		struct Multiplies {static Unreduced apply(const Unreduced &a, const Unreduced &b) {return multiply(a, b);}};
+		struct Divides    {static Unreduced apply(const Unreduced &a, const Unreduced &b) {return multiply(a, reciprocal(b));}};
+
+		/**
+		 * An operand of an expression, copied so that expressions can outlive the Fractions they were built from.
+		 */
+		class Leaf {
+			Fraction value;
+		public:
+			explicit Leaf(const Fraction &value) : value(value) {}
+			Unreduced unreduced() const {
+				Unreduced result = {value.num(), value.den(), !value.valid()};
+				if (result.n < -checked_limit || result.d < -checked_limit) {
+					result = {0, 1, true};
+					return result;
+				}
+				// invert(Fraction&) may leave a negative denominator behind
+				if (result.d < 0) {
+					result.n = -result.n;
+					result.d = -result.d;
+				}
+				return result;
+			}
+		};
+
+		template <typename L, typename R, typename Op>
+		class Binary {
+			L lhs;
+			R rhs;
+		public:
+			Binary(const L &lhs, const R &rhs) : lhs(lhs), rhs(rhs) {}
+			Unreduced unreduced() const {return Op::apply(lhs.unreduced(), rhs.unreduced());}
+		};
+
+		template <typename N>
+		class Negate {
+			N operand;
+		public:
+			explicit Negate(const N &operand) : operand(operand) {}
+			Unreduced unreduced() const {
+				// intermediates stay within ±checked_limit, so this cannot overflow
+				Unreduced result = operand.unreduced();
+				result.n = -result.n;
+				return result;
+			}
+		};
+	}
+
+	/**
+	 * \brief A lazily evaluated Fraction expression.
+	 *
+	 * Every Fraction operator returns a normalized Fraction, so <tt>a + b * c - d</tt> runs the constructor's gcd
+	 * three times. Expressions started with <tt>lazy()</tt> instead keep their intermediates unreduced and reduce
+	 * once when converted to a Fraction; intermediates are only reduced early if they would overflow otherwise.
+	 * If even the reduced intermediates overflow, the result is an invalid Fraction.
+	 *
+	 * \code
+	 * Fraction r = lazy(a) + lazy(b) * c - d;
+	 * \endcode
+	 *
+	 * @tparam Node The expression tree.
+	 */
+	template <typename Node>
+	class FractionExpression {
+
+	private:
+		Node node;
+
+	public:
+		explicit FractionExpression(const Node &node) : node(node) {}
+
+		const Node& tree() const {return node;}
+
+		/**
+		 * Evaluates the expression with a single final reduction.
+		 *
+		 * @return The value as a Fraction.
+		 */
+		Fraction eval() const {
+			detail::Unreduced result = node.unreduced();
+			if (result.invalid) return INVALID_FRACTION;
+			return Fraction(result.n, result.d);
+		}
+
+		operator Fraction() const {return eval();} // NOLINT
+	};
+
+	/**
+	 * Starts a lazily evaluated expression.
+	 *
+	 * @param frac The first operand.
+	 * @return An expression evaluating to <tt>frac</tt>.
+	 */
+	inline FractionExpression<detail::Leaf> lazy(const Fraction &frac) {
+		return FractionExpression<detail::Leaf>(detail::Leaf(frac));
+	}
+
+	template <typename L>
+	FractionExpression<detail::Negate<L>> operator-(const FractionExpression<L> &operand) {
+		return FractionExpression<detail::Negate<L>>(detail::Negate<L>(operand.tree()));
+	}
+
+#define NPASSON_EXPRESSION_OPERATOR(op, Op)                                                                            \
+	template <typename L, typename R>                                                                                  \
+	FractionExpression<detail::Binary<L, R, detail::Op>>                                                               \
+	operator op (const FractionExpression<L> &lhs, const FractionExpression<R> &rhs) {                                 \
+		return FractionExpression<detail::Binary<L, R, detail::Op>>(detail::Binary<L, R, detail::Op>(lhs.tree(), rhs.tree())); \
+	}                                                                                                                  \
+	template <typename L>                                                                                              \
+	FractionExpression<detail::Binary<L, detail::Leaf, detail::Op>>                                                    \
+	operator op (const FractionExpression<L> &lhs, const Fraction &rhs) {                                              \
+		return lhs op lazy(rhs);                                                                                       \
+	}                                                                                                                  \
+	template <typename R>                                                                                              \
+	FractionExpression<detail::Binary<detail::Leaf, R, detail::Op>>                                                    \
+	operator op (const Fraction &lhs, const FractionExpression<R> &rhs) {                                              \
+		return lazy(lhs) op rhs;                                                                                       \
+	}                                                                                                                  \
+	template <typename L, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>            \
+	FractionExpression<detail::Binary<L, detail::Leaf, detail::Op>>                                                    \
+	operator op (const FractionExpression<L> &lhs, T rhs) {                                                            \
+		return lhs op lazy(Fraction(static_cast<long long signed int>(rhs)));                                          \
+	}                                                                                                                  \
+	template <typename T, typename R, typename = typename std::enable_if<std::is_integral<T>::value>::type>            \
+	FractionExpression<detail::Binary<detail::Leaf, R, detail::Op>>                                                    \
+	operator op (T lhs, const FractionExpression<R> &rhs) {                                                            \
+		return lazy(Fraction(static_cast<long long signed int>(lhs))) op rhs;                                          \
+	}
+
+	NPASSON_EXPRESSION_OPERATOR(+, Plus)
+	NPASSON_EXPRESSION_OPERATOR(-, Minus)
+	NPASSON_EXPRESSION_OPERATOR(*, Multiplies)
+	NPASSON_EXPRESSION_OPERATOR(/, Divides)
+
+#undef NPASSON_EXPRESSION_OPERATOR
+
+	/**
+	 * \brief Fused multiply-add, <tt>a * b + c</tt> with a single reduction.
+	 */
+	inline Fraction fma(const Fraction &a, const Fraction &b, const Fraction &c) {
+		return (lazy(a) * b + c).eval();
+	}
+
+	/**
+	 * \brief Fused multiply-multiply-add, <tt>a * b + c * d</tt> with a single reduction.
+	 */
+	inline Fraction fmma(const Fraction &a, const Fraction &b, const Fraction &c, const Fraction &d) {
+		return (lazy(a) * b + lazy(c) * d).eval();
+	}
+}
+
+#endif //NPASSON_FRACTION_EXPRESSION_HPP
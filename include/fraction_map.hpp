@@ -0,0 +1,268 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file fraction_map.hpp
+ * Contains FractionMap, an open addressing hash map with Fraction keys, and FractionInterner.
+ */
+
+#ifndef NPASSON_FRACTION_MAP_HPP
+#define NPASSON_FRACTION_MAP_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "fraction.hpp"
+
+namespace npasson {
+
+	/**
+	 * \brief A hash map from Fractions to <tt>V</tt>, with open addressing and linear probing.
+	 *
+	 * Keys are stored as their reduced numerator and denominator next to the value, so lookups touch one
+	 * contiguous slot array instead of chasing nodes. A separate byte per slot marks it empty or holds seven bits
+	 * of the key's hash, which rejects almost all non-matching slots without comparing keys. The table doubles
+	 * at a load of 3/4 and erasing shifts the following cluster back instead of leaving tombstones.
+	 *
+	 * All invalid Fractions are one key, separate from every valid one. So is the value <tt>1/-2^63</tt> that
+	 * <tt>invert(Fraction&)</tt> can leave behind, which has no form with a positive denominator.
+	 *
+	 * @tparam V The mapped type, default constructible.
+	 */
+	template <typename V>
+	class FractionMap {
+
+	private:
+		struct Slot {
+			long long signed int num;
+			long long signed int den;
+			std::size_t hash; // kept so that growing and erasing need not rehash keys
+			V value;
+		};
+
+		enum : unsigned char {empty = 0};
+
+		std::vector<Slot> slots;
+		std::vector<unsigned char> control;
+		std::size_t count = 0;
+		std::size_t mask = 0;
+
+		static void canonical(const Fraction &key, long long signed int &num, long long signed int &den) {
+			const long long signed int limit = 9223372036854775807ll;
+			if (!key.valid() || key.den() < -limit || (key.den() < 0 && key.num() < -limit)) {
+				num = 0;
+				den = 0;
+				return;
+			}
+			// invert(Fraction&) may leave a negative denominator behind
+			num = (key.den() < 0) ? -key.num() : key.num();
+			den = (key.den() < 0) ? -key.den() : key.den();
+		}
+
+		// the top seven bits, which probing uses last
+		static unsigned char tag(std::size_t hash) {
+			return static_cast<unsigned char>(0x80 | (hash >> (sizeof(std::size_t) * 8 - 7)));
+		}
+
+		/**
+		 * Returns the slot holding <tt>key</tt> or the empty slot where it would go.
+		 */
+		std::size_t probe(const Fraction &key, std::size_t key_hash) const {
+			long long signed int num, den;
+			canonical(key, num, den);
+			unsigned char wanted = tag(key_hash);
+			std::size_t i = key_hash & mask;
+			while (control[i] != empty) {
+				if (control[i] == wanted && slots[i].num == num && slots[i].den == den) return i;
+				i = (i + 1) & mask;
+			}
+			return i;
+		}
+
+		void rehash(std::size_t capacity) {
+			std::vector<Slot> old_slots(capacity);
+			std::vector<unsigned char> old_control(capacity, empty);
+			old_slots.swap(slots);
+			old_control.swap(control);
+			mask = capacity - 1;
+			for (std::size_t i = 0; i < old_control.size(); ++i) {
+				if (old_control[i] == empty) continue;
+				std::size_t j = old_slots[i].hash & mask;
+				while (control[j] != empty) j = (j + 1) & mask;
+				control[j] = old_control[i];
+				slots[j] = std::move(old_slots[i]);
+			}
+		}
+
+	public:
+		FractionMap() {
+			rehash(16);
+		}
+
+		/**
+		 * \brief The hash the map uses for <tt>key</tt>.
+		 *
+		 * Callers that look up the same key several times, or pick a shard by the hash first, can compute it once
+		 * and pass it to the overloads of <tt>find()</tt> and <tt>insert()</tt> that take it.
+		 */
+		static std::size_t hash(const Fraction &key) {
+			long long signed int num, den;
+			canonical(key, num, den);
+			return (den == 0) ? 0 : key.hash();
+		}
+
+		std::size_t size()     const {return count;}
+		bool        is_empty() const {return count == 0;}
+
+		/**
+		 * Makes room for <tt>n</tt> keys without further rehashing.
+		 */
+		void reserve(std::size_t n) {
+			std::size_t capacity = slots.size();
+			while (n > capacity / 4 * 3) capacity *= 2;
+			if (capacity != slots.size()) rehash(capacity);
+		}
+
+		void clear() {
+			std::vector<Slot>(16).swap(slots);
+			std::vector<unsigned char>(16, empty).swap(control);
+			mask = 15;
+			count = 0;
+		}
+
+		/**
+		 * @return The value mapped to <tt>key</tt>, or <tt>nullptr</tt>.
+		 */
+		V* find(const Fraction &key) {return find(key, hash(key));}
+		const V* find(const Fraction &key) const {return find(key, hash(key));}
+
+		/**
+		 * @return The value mapped to <tt>key</tt>, whose <tt>hash()</tt> is <tt>key_hash</tt>, or <tt>nullptr</tt>.
+		 */
+		V* find(const Fraction &key, std::size_t key_hash) {
+			std::size_t i = probe(key, key_hash);
+			return (control[i] == empty) ? nullptr : &slots[i].value;
+		}
+		const V* find(const Fraction &key, std::size_t key_hash) const {
+			std::size_t i = probe(key, key_hash);
+			return (control[i] == empty) ? nullptr : &slots[i].value;
+		}
+
+		/**
+		 * \brief Inserts <tt>value</tt> under <tt>key</tt> unless the key is present.
+		 *
+		 * @return The mapped value and whether it was inserted.
+		 */
+		std::pair<V*, bool> insert(const Fraction &key, const V &value) {
+			return insert(key, value, hash(key));
+		}
+
+		/**
+		 * Inserts like <tt>insert(key, value)</tt>, with <tt>key_hash</tt> the <tt>hash()</tt> of <tt>key</tt>.
+		 */
+		std::pair<V*, bool> insert(const Fraction &key, const V &value, std::size_t key_hash) {
+			if (count + 1 > slots.size() / 4 * 3) rehash(slots.size() * 2);
+			std::size_t i = probe(key, key_hash);
+			if (control[i] != empty) return std::make_pair(&slots[i].value, false);
+			canonical(key, slots[i].num, slots[i].den);
+			slots[i].hash = key_hash;
+			slots[i].value = value;
+			control[i] = tag(key_hash);
+			++count;
+			return std::make_pair(&slots[i].value, true);
+		}
+
+		V& operator[](const Fraction &key) {
+			return *insert(key, V()).first;
+		}
+
+		/**
+		 * \brief Removes <tt>key</tt>.
+		 *
+		 * Moves every following entry of the cluster that may sit in the freed slot back into it, so lookups never
+		 * need to skip deleted slots.
+		 *
+		 * @return If the key was present.
+		 */
+		bool erase(const Fraction &key) {
+			std::size_t i = probe(key, hash(key));
+			if (control[i] == empty) return false;
+			std::size_t j = i;
+			while (true) {
+				j = (j + 1) & mask;
+				if (control[j] == empty) break;
+				std::size_t home = slots[j].hash & mask;
+				// move j back to i unless its home lies cyclically within (i, j]
+				if ((i <= j) ? (i < home && home <= j) : (i < home || home <= j)) continue;
+				slots[i] = std::move(slots[j]);
+				control[i] = control[j];
+				i = j;
+			}
+			control[i] = empty;
+			slots[i] = Slot();
+			--count;
+			return true;
+		}
+
+		/**
+		 * Calls <tt>f(key, value)</tt> for every entry, in no particular order. The invalid key is passed as an
+		 * invalid Fraction.
+		 */
+		template <typename F>
+		void for_each(F f) const {
+			for (std::size_t i = 0; i < control.size(); ++i) {
+				if (control[i] != empty) f(Fraction(slots[i].num, slots[i].den), slots[i].value);
+			}
+		}
+	};
+
+	/**
+	 * \brief Assigns every distinct Fraction a dense id, starting at zero.
+	 *
+	 * Lets the same values, e.g. the keys of a column, be stored and compared as 32 bit ids.
+	 */
+	class FractionInterner {
+
+	private:
+		FractionMap<unsigned int> ids;
+		std::vector<Fraction> values;
+
+	public:
+		/**
+		 * @return The id of <tt>frac</tt>, newly assigned if it was not seen before.
+		 */
+		unsigned int intern(const Fraction &frac) {
+			std::pair<unsigned int*, bool> entry = ids.insert(frac, static_cast<unsigned int>(values.size()));
+			if (entry.second) values.push_back(frac);
+			return *entry.first;
+		}
+
+		/**
+		 * @return The Fraction with the given id.
+		 */
+		const Fraction& value(unsigned int id) const {return values[id];}
+
+		std::size_t size() const {return values.size();}
+	};
+}
+
+#endif //NPASSON_FRACTION_MAP_HPP
@@ -0,0 +1,440 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file fraction_polynomial.cpp
+ * The code of the FractionPolynomial class.
+ */
+
+#include <algorithm>
+#include <utility>
+
+#ifndef NPASSON_EXPERIMENTAL_COMPILE
+	#include "fraction_polynomial.hpp"
+#endif
+
+#include "checked_arithmetic.hpp"
+#include "fraction_expression.hpp"
+
+#ifndef NPASSON_KARATSUBA_THRESHOLD
+#define NPASSON_KARATSUBA_THRESHOLD 32
+#endif
+
+namespace npasson {
+
+	namespace detail {
+
+		/**
+		 * <tt>n/d</tt> with <tt>d > 0</tt> as a Fraction, invalid if it does not fit even after reducing.
+		 */
+		inline Fraction polynomial_fraction(wide_int n, wide_int d) {
+			long long signed int num, den;
+			return narrow(n, d, num, den) ? Fraction(num, den) : INVALID_FRACTION;
+		}
+
+		/**
+		 * \brief Scales the coefficients to integers by the lcm of their denominators.
+		 *
+		 * @return <tt>false</tt> if a coefficient is invalid or the scaled values overflow.
+		 */
+		inline bool polynomial_scale(const std::vector<Fraction> &coefficients, std::vector<wide_int> &scaled,
+		                             wide_int &scale) {
+			scale = 1;
+			for (const Fraction &c : coefficients) {
+				if (!c.valid()) return false;
+				wide_int den = (c.den() < 0) ? -static_cast<wide_int>(c.den()) : c.den();
+				if (!checked_mul(scale / wide_gcd(scale, den), den, &scale)) return false;
+			}
+			scaled.resize(coefficients.size());
+			for (std::size_t i = 0; i < coefficients.size(); ++i) {
+				// a denominator may be negative after Fraction::invert()
+				wide_int num = coefficients[i].num();
+				wide_int den = coefficients[i].den();
+				if (den < 0) {
+					num = -num;
+					den = -den;
+				}
+				if (!checked_mul(num, scale / den, &scaled[i])) return false;
+			}
+			return true;
+		}
+
+		/**
+		 * Adds <tt>a * b</tt> to <tt>out</tt>, which holds <tt>na + nb - 1</tt> entries.
+		 */
+		inline bool polynomial_schoolbook(const wide_int* a, std::size_t na, const wide_int* b, std::size_t nb,
+		                                  wide_int* out) {
+			wide_int product;
+			for (std::size_t i = 0; i < na; ++i) {
+				if (a[i] == 0) continue;
+				for (std::size_t j = 0; j < nb; ++j) {
+					if (!checked_mul(a[i], b[j], &product) || !checked_add(out[i + j], product, &out[i + j])) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * \brief Adds <tt>a * b</tt> to <tt>out</tt> for two operands of <tt>n</tt> coefficients each.
+		 *
+		 * Splits both at <tt>n/2</tt> and gets along with three half size products,
+		 * <tt>(a0 + a1)(b0 + b1) - a0*b0 - a1*b1</tt> being the middle part.
+		 */
+		inline bool polynomial_karatsuba(const wide_int* a, const wide_int* b, std::size_t n, wide_int* out) {
+			if (n <= NPASSON_KARATSUBA_THRESHOLD) return polynomial_schoolbook(a, n, b, n, out);
+
+			std::size_t low = n / 2;
+			std::size_t high = n - low;
+			std::vector<wide_int> sum_a(a + low, a + n);
+			std::vector<wide_int> sum_b(b + low, b + n);
+			for (std::size_t i = 0; i < low; ++i) {
+				if (!checked_add(sum_a[i], a[i], &sum_a[i]) || !checked_add(sum_b[i], b[i], &sum_b[i])) return false;
+			}
+
+			std::vector<wide_int> low_product(2 * low - 1, 0);
+			std::vector<wide_int> high_product(2 * high - 1, 0);
+			std::vector<wide_int> middle(2 * high - 1, 0);
+			if (!polynomial_karatsuba(a, b, low, low_product.data())
+			 || !polynomial_karatsuba(a + low, b + low, high, high_product.data())
+			 || !polynomial_karatsuba(sum_a.data(), sum_b.data(), high, middle.data())) {
+				return false;
+			}
+
+			for (std::size_t i = 0; i < low_product.size(); ++i) {
+				if (!checked_sub(middle[i], low_product[i], &middle[i])
+				 || !checked_add(out[i], low_product[i], &out[i])) return false;
+			}
+			for (std::size_t i = 0; i < high_product.size(); ++i) {
+				if (!checked_sub(middle[i], high_product[i], &middle[i])
+				 || !checked_add(out[i + 2 * low], high_product[i], &out[i + 2 * low])) return false;
+			}
+			for (std::size_t i = 0; i < middle.size(); ++i) {
+				if (!checked_add(out[i + low], middle[i], &out[i + low])) return false;
+			}
+			return true;
+		}
+	}
+
+	/**
+	 * Removes trailing zero coefficients. Invalid coefficients are kept, so the result stays invalid.
+	 */
+	void FractionPolynomial::trim() {
+		while (!coefficients.empty() && coefficients.back().valid() && coefficients.back().num() == 0) {
+			coefficients.pop_back();
+		}
+	}
+
+	/**
+	 * Creates the constant polynomial <tt>c</tt>.
+	 */
+	FractionPolynomial::FractionPolynomial(const Fraction &c) : coefficients(1, c) {
+		trim();
+	}
+
+	/**
+	 * Creates a polynomial from its coefficients, constant term first.
+	 */
+	FractionPolynomial::FractionPolynomial(std::initializer_list<Fraction> c) : coefficients(c) {
+		trim();
+	}
+
+	/**
+	 * Creates a polynomial from its coefficients, constant term first.
+	 */
+	FractionPolynomial::FractionPolynomial(std::vector<Fraction> c) : coefficients(std::move(c)) {
+		trim();
+	}
+
+	/**
+	 * @return <tt>c * x^degree</tt>, or an invalid polynomial if no vector can hold that many coefficients.
+	 */
+	FractionPolynomial FractionPolynomial::monomial(const Fraction &c, std::size_t degree) {
+		std::vector<Fraction> result;
+		if (degree >= result.max_size()) return FractionPolynomial(INVALID_FRACTION);
+		result.assign(degree + 1, Fraction(0));
+		result[degree] = c;
+		return FractionPolynomial(std::move(result));
+	}
+
+	/**
+	 * @return <tt>false</tt> if any coefficient is invalid, e.g. after an overflow.
+	 */
+	bool FractionPolynomial::valid() const {
+		for (const Fraction &c : coefficients) if (!c.valid()) return false;
+		return true;
+	}
+
+	/**
+	 * @return The coefficient of <tt>x^i</tt>, which is 0 beyond the degree.
+	 */
+	Fraction FractionPolynomial::operator[](std::size_t i) const {
+		return (i < coefficients.size()) ? coefficients[i] : Fraction(0);
+	}
+
+	/**
+	 * Returns the polynomial as e.g. <tt>(3/2)x^2 + (-1/1)x + (1/1)</tt>, highest power first.
+	 */
+	std::string FractionPolynomial::str() const {
+		if (coefficients.empty()) return "0";
+		std::string result;
+		for (std::size_t i = coefficients.size(); i-- > 0;) {
+			if (coefficients[i].valid() && coefficients[i].num() == 0) continue;
+			if (!result.empty()) result += " + ";
+			result += "(" + coefficients[i].f_str() + ")";
+			if (i > 0) result += "x";
+			if (i > 1) result += "^" + std::to_string(i);
+		}
+		return result;
+	}
+
+	FractionPolynomial FractionPolynomial::derivative() const {
+		std::vector<Fraction> result;
+		for (std::size_t i = 1; i < coefficients.size(); ++i) {
+			result.push_back((lazy(coefficients[i]) * static_cast<long long signed int>(i)).eval());
+		}
+		return FractionPolynomial(std::move(result));
+	}
+
+	/**
+	 * \brief Polynomial long division, <tt>this = quotient * divisor + remainder</tt>.
+	 *
+	 * The remainder's degree is below the divisor's. Dividing by the zero polynomial makes both results invalid.
+	 *
+	 * @param divisor The polynomial to divide by.
+	 * @param quotient Receives the quotient.
+	 * @param remainder Receives the remainder.
+	 */
+	void FractionPolynomial::divmod(const FractionPolynomial &divisor, FractionPolynomial &quotient,
+	                                FractionPolynomial &remainder) const {
+		if (divisor.is_zero()) {
+			quotient = FractionPolynomial(INVALID_FRACTION);
+			remainder = FractionPolynomial(INVALID_FRACTION);
+			return;
+		}
+		std::vector<Fraction> rest = coefficients;
+		const std::vector<Fraction> &d = divisor.coefficients;
+		std::size_t dd = d.size() - 1;
+		if (rest.size() <= dd) {
+			quotient = FractionPolynomial();
+			remainder = FractionPolynomial(std::move(rest));
+			return;
+		}
+
+		std::vector<Fraction> q(rest.size() - dd);
+		for (std::size_t k = q.size(); k-- > 0;) {
+			q[k] = (lazy(rest[k + dd]) / d[dd]).eval();
+			for (std::size_t j = 0; j < dd; ++j) {
+				rest[k + j] = (lazy(rest[k + j]) - lazy(q[k]) * d[j]).eval();
+			}
+		}
+		rest.resize(dd);
+		quotient = FractionPolynomial(std::move(q));
+		remainder = FractionPolynomial(std::move(rest));
+	}
+
+	/**
+	 * \brief The value at <tt>x</tt>.
+	 *
+	 * With the coefficients scaled to integers <tt>A_i</tt> by their common denominator <tt>s</tt>, and
+	 * <tt>x = p/q</tt>, Horner's scheme runs on <tt>sum A_i p^i q^(n-i)</tt> and a single division by
+	 * <tt>s * q^n</tt> gives the result. If that overflows, Horner's scheme runs on Fractions instead.
+	 */
+	Fraction FractionPolynomial::evaluate(const Fraction &x) const {
+		Fraction result;
+		evaluate(&x, &result, 1);
+		return result;
+	}
+
+	/**
+	 * \brief The values at <tt>count</tt> points in one pass.
+	 *
+	 * The coefficients are scaled only once, and the points are processed in small blocks that step through
+	 * the coefficients together, which keeps the independent multiplications of several points in flight.
+	 *
+	 * @param x The points.
+	 * @param out Receives the values; may be the same array as <tt>x</tt>.
+	 * @param count The number of points.
+	 */
+	void FractionPolynomial::evaluate(const Fraction* x, Fraction* out, std::size_t count) const {
+		const std::size_t n = coefficients.size();
+		if (n == 0) {
+			for (std::size_t i = 0; i < count; ++i) out[i] = x[i].valid() ? Fraction(0) : INVALID_FRACTION;
+			return;
+		}
+
+		std::vector<detail::wide_int> scaled;
+		detail::wide_int scale;
+		bool scaled_ok = detail::polynomial_scale(coefficients, scaled, scale);
+
+		const std::size_t block = 4;
+		for (std::size_t start = 0; start < count; start += block) {
+			std::size_t width = std::min(block, count - start);
+			detail::wide_int p[block], q[block], value[block], power[block], term;
+			bool ok[block];
+			for (std::size_t k = 0; k < width; ++k) {
+				ok[k] = scaled_ok && x[start + k].valid();
+				p[k] = (x[start + k].den() < 0) ? -static_cast<detail::wide_int>(x[start + k].num()) : x[start + k].num();
+				q[k] = (x[start + k].den() < 0) ? -static_cast<detail::wide_int>(x[start + k].den()) : x[start + k].den();
+				value[k] = scaled_ok ? scaled[n - 1] : 0;
+				power[k] = 1;
+			}
+			if (scaled_ok) {
+				for (std::size_t i = n - 1; i-- > 0;) {
+					for (std::size_t k = 0; k < width; ++k) {
+						ok[k] = ok[k]
+						     && detail::checked_mul(power[k], q[k], &power[k])
+						     && detail::checked_mul(value[k], p[k], &value[k])
+						     && detail::checked_mul(scaled[i], power[k], &term)
+						     && detail::checked_add(value[k], term, &value[k]);
+					}
+				}
+			}
+			for (std::size_t k = 0; k < width; ++k) {
+				if (ok[k] && detail::checked_mul(power[k], scale, &power[k])) {
+					out[start + k] = detail::polynomial_fraction(value[k], power[k]);
+					continue;
+				}
+				Fraction point = x[start + k];
+				Fraction result = coefficients[n - 1];
+				for (std::size_t i = n - 1; i-- > 0;) result = fma(result, point, coefficients[i]);
+				out[start + k] = point.valid() ? result : INVALID_FRACTION;
+			}
+		}
+	}
+
+	FractionPolynomial FractionPolynomial::operator-() const {
+		std::vector<Fraction> result(coefficients.size());
+		for (std::size_t i = 0; i < coefficients.size(); ++i) result[i] = (-lazy(coefficients[i])).eval();
+		return FractionPolynomial(std::move(result));
+	}
+
+	FractionPolynomial& FractionPolynomial::operator+=(const FractionPolynomial &rhs) {
+		if (coefficients.size() < rhs.coefficients.size()) coefficients.resize(rhs.coefficients.size(), Fraction(0));
+		for (std::size_t i = 0; i < rhs.coefficients.size(); ++i) {
+			coefficients[i] = (lazy(coefficients[i]) + rhs.coefficients[i]).eval();
+		}
+		trim();
+		return *this;
+	}
+	FractionPolynomial  FractionPolynomial::operator+ (const FractionPolynomial &rhs) const {
+		FractionPolynomial temp = (*this);
+		return temp += rhs;
+	}
+
+	FractionPolynomial& FractionPolynomial::operator-=(const FractionPolynomial &rhs) {
+		if (coefficients.size() < rhs.coefficients.size()) coefficients.resize(rhs.coefficients.size(), Fraction(0));
+		for (std::size_t i = 0; i < rhs.coefficients.size(); ++i) {
+			coefficients[i] = (lazy(coefficients[i]) - rhs.coefficients[i]).eval();
+		}
+		trim();
+		return *this;
+	}
+	FractionPolynomial  FractionPolynomial::operator- (const FractionPolynomial &rhs) const {
+		FractionPolynomial temp = (*this);
+		return temp -= rhs;
+	}
+
+	/**
+	 * \brief Multiplies by Karatsuba on the integer-scaled coefficients.
+	 *
+	 * Both operands are scaled to integers by the lcm of their denominators, multiplied (schoolbook below
+	 * <tt>NPASSON_KARATSUBA_THRESHOLD</tt> coefficients), and each product coefficient is divided by the
+	 * product of both scales once. If anything overflows, the schoolbook product runs on Fractions instead.
+	 */
+	FractionPolynomial& FractionPolynomial::operator*=(const FractionPolynomial &rhs) {
+		if (coefficients.empty() || rhs.coefficients.empty()) {
+			coefficients.clear();
+			return *this;
+		}
+		const std::size_t na = coefficients.size();
+		const std::size_t nb = rhs.coefficients.size();
+
+		std::vector<detail::wide_int> a, b;
+		detail::wide_int scale_a, scale_b, scale;
+		if (detail::polynomial_scale(coefficients, a, scale_a) && detail::polynomial_scale(rhs.coefficients, b, scale_b)
+		 && detail::checked_mul(scale_a, scale_b, &scale)) {
+			bool ok;
+			std::vector<detail::wide_int> product;
+			if (std::min(na, nb) <= NPASSON_KARATSUBA_THRESHOLD) {
+				product.assign(na + nb - 1, 0);
+				ok = detail::polynomial_schoolbook(a.data(), na, b.data(), nb, product.data());
+			} else {
+				// pad the shorter operand; the products of the padding are zero
+				std::size_t n = std::max(na, nb);
+				a.resize(n, 0);
+				b.resize(n, 0);
+				product.assign(2 * n - 1, 0);
+				ok = detail::polynomial_karatsuba(a.data(), b.data(), n, product.data());
+			}
+			if (ok) {
+				std::vector<Fraction> result(na + nb - 1);
+				for (std::size_t i = 0; i < result.size(); ++i) result[i] = detail::polynomial_fraction(product[i], scale);
+				coefficients = std::move(result);
+				trim();
+				return *this;
+			}
+		}
+
+		std::vector<Fraction> result(na + nb - 1, Fraction(0));
+		for (std::size_t i = 0; i < na; ++i) {
+			for (std::size_t j = 0; j < nb; ++j) {
+				result[i + j] = fma(coefficients[i], rhs.coefficients[j], result[i + j]);
+			}
+		}
+		coefficients = std::move(result);
+		trim();
+		return *this;
+	}
+	FractionPolynomial  FractionPolynomial::operator* (const FractionPolynomial &rhs) const {
+		FractionPolynomial temp = (*this);
+		return temp *= rhs;
+	}
+
+	FractionPolynomial& FractionPolynomial::operator/=(const FractionPolynomial &rhs) {
+		FractionPolynomial remainder;
+		divmod(rhs, *this, remainder);
+		return *this;
+	}
+	FractionPolynomial  FractionPolynomial::operator/ (const FractionPolynomial &rhs) const {
+		FractionPolynomial temp = (*this);
+		return temp /= rhs;
+	}
+
+	FractionPolynomial& FractionPolynomial::operator%=(const FractionPolynomial &rhs) {
+		FractionPolynomial quotient;
+		divmod(rhs, quotient, *this);
+		return *this;
+	}
+	FractionPolynomial  FractionPolynomial::operator% (const FractionPolynomial &rhs) const {
+		FractionPolynomial temp = (*this);
+		return temp %= rhs;
+	}
+
+	bool FractionPolynomial::operator==(const FractionPolynomial &rhs) const {
+		return coefficients == rhs.coefficients;
+	}
+	bool FractionPolynomial::operator!=(const FractionPolynomial &rhs) const {
+		return !(*this == rhs);
+	}
+}
+
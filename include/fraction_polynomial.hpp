@@ -0,0 +1,101 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file fraction_polynomial.hpp
+ * Contains FractionPolynomial, polynomials with exact Fraction coefficients.
+ */
+
+#ifndef NPASSON_FRACTION_POLYNOMIAL_HPP
+#define NPASSON_FRACTION_POLYNOMIAL_HPP
+
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "fraction.hpp"
+
+namespace npasson {
+
+	/**
+	 * \brief A polynomial with Fraction coefficients.
+	 *
+	 * Coefficients are stored from the constant term upwards, without trailing zeros, so the zero polynomial
+	 * has no coefficients and a degree of -1.
+	 *
+	 * Multiplication and evaluation scale the coefficients to integers by their common denominator first, so
+	 * they run on plain (128 bit where available) integer arithmetic instead of reducing after every step:
+	 * products use Karatsuba on the scaled coefficients, and evaluation at <tt>p/q</tt> uses Horner's scheme
+	 * on <tt>q^n * P(p/q)</tt>, dividing only once at the end. Where the integers overflow, both fall back to
+	 * Fraction arithmetic, and coefficients or values that do not fit a Fraction come out invalid.
+	 */
+	class FractionPolynomial {
+
+	private:
+		std::vector<Fraction> coefficients;
+
+		void trim();
+
+	public:
+		FractionPolynomial() = default;
+		FractionPolynomial(const Fraction&); // NOLINT
+		FractionPolynomial(std::initializer_list<Fraction>);
+		explicit FractionPolynomial(std::vector<Fraction>);
+
+		static FractionPolynomial monomial(const Fraction&, std::size_t);
+
+		long long signed int degree() const {return static_cast<long long signed int>(coefficients.size()) - 1;}
+		bool is_zero() const {return coefficients.empty();}
+		bool valid() const;
+		Fraction operator[](std::size_t) const;
+		const std::vector<Fraction>& coefficient_list() const {return coefficients;}
+		std::string str() const;
+
+		FractionPolynomial derivative() const;
+		void divmod(const FractionPolynomial&, FractionPolynomial&, FractionPolynomial&) const;
+
+		Fraction evaluate(const Fraction&) const;
+		void evaluate(const Fraction*, Fraction*, std::size_t) const;
+		Fraction operator()(const Fraction &x) const {return evaluate(x);}
+
+		FractionPolynomial  operator -  () const;
+		FractionPolynomial& operator += (const FractionPolynomial&);
+		FractionPolynomial  operator +  (const FractionPolynomial&) const;
+		FractionPolynomial& operator -= (const FractionPolynomial&);
+		FractionPolynomial  operator -  (const FractionPolynomial&) const;
+		FractionPolynomial& operator *= (const FractionPolynomial&);
+		FractionPolynomial  operator *  (const FractionPolynomial&) const;
+		FractionPolynomial& operator /= (const FractionPolynomial&);
+		FractionPolynomial  operator /  (const FractionPolynomial&) const;
+		FractionPolynomial& operator %= (const FractionPolynomial&);
+		FractionPolynomial  operator %  (const FractionPolynomial&) const;
+
+		bool operator == (const FractionPolynomial&) const;
+		bool operator != (const FractionPolynomial&) const;
+	};
+}
+
+#ifdef NPASSON_EXPERIMENTAL_COMPILE
+#include "fraction_polynomial.cpp"
+#endif
+
+#endif //NPASSON_FRACTION_POLYNOMIAL_HPP
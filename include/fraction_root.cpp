@@ -0,0 +1,285 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file fraction_root.cpp
+ * The code of <tt>Fraction::root()</tt> and <tt>Fraction::sqrt()</tt>.
+ *
+ * Kept apart from fraction.cpp since it needs BigInteger: compile it together with big_integer.cpp if you use
+ * either function.
+ */
+
+#ifndef NPASSON_EXPERIMENTAL_COMPILE
+	#include "fraction.hpp"
+#endif
+
+#include "big_integer.hpp"
+
+namespace npasson {
+
+	namespace detail {
+
+		/**
+		 * \brief <tt>floor(v^(1/n))</tt> by integer Newton iteration.
+		 *
+		 * Starts above the root, from where the iteration <tt>x = ((n-1)x + v/x^(n-1)) / n</tt> decreases
+		 * until it reaches the floor of the root.
+		 */
+		inline unsigned long long int integer_root(unsigned long long int v, unsigned int n) {
+			if (v < 2 || n == 1) return v;
+			if (n >= 64) return 1;
+			unsigned int bits = 0;
+			for (unsigned long long int rest = v; rest != 0; rest >>= 1) ++bits;
+			unsigned long long int x = 1ull << ((bits + n - 1) / n);
+			while (true) {
+				unsigned long long int quotient = v;
+				for (unsigned int i = 1; i < n && quotient != 0; ++i) quotient /= x;
+				unsigned long long int next = ((n - 1) * x + quotient) / n;
+				if (next >= x) return x;
+				x = next;
+			}
+		}
+
+		/**
+		 * @return Whether <tt>r^n == v</tt>.
+		 */
+		inline bool is_power(unsigned long long int r, unsigned int n, unsigned long long int v) {
+			unsigned long long int power = 1;
+			for (unsigned int i = 0; i < n; ++i) {
+				if (r != 0 && power > v / r) return false;
+				power *= r;
+			}
+			return power == v;
+		}
+
+		/**
+		 * @return <tt>|x|</tt>, negated in unsigned so that the most negative value survives.
+		 */
+		inline unsigned long long int root_magnitude(long long signed int x) {
+			return (x < 0) ? 0ull - static_cast<unsigned long long int>(x) : static_cast<unsigned long long int>(x);
+		}
+
+		/**
+		 * @return <tt>v</tt> as a BigInteger, including <tt>2^63</tt>.
+		 */
+		inline BigInteger big_magnitude(unsigned long long int v) {
+			if (v <= 9223372036854775807ull) return BigInteger(static_cast<long long signed int>(v));
+			return BigInteger(static_cast<long long signed int>(v >> 1)) * BigInteger(2) + BigInteger(static_cast<long long signed int>(v & 1));
+		}
+
+		inline BigInteger big_power(BigInteger base, unsigned int n) {
+			BigInteger result(1);
+			while (n != 0) {
+				if (n & 1u) result *= base;
+				n >>= 1;
+				if (n != 0) base *= base;
+			}
+			return result;
+		}
+
+		/**
+		 * \brief Locates fractions relative to <tt>(p/q)^(1/n)</tt>, widened by a tolerance <tt>tp/tq</tt>.
+		 *
+		 * All four are magnitudes, so that a numerator or denominator of <tt>-2^63</tt> can be taken apart.
+		 */
+		struct RootTarget {
+			unsigned long long int p, q;
+			unsigned int n;
+			unsigned long long int tp, tq;
+
+			/**
+			 * @return The sign of <tt>h/k - (p/q)^(1/n)</tt>, for <tt>k > 0</tt>.
+			 */
+			int compare(const BigInteger &h, const BigInteger &k) const {
+				if (h.sign() <= 0) return -1;
+				return (big_power(h, n) * big_magnitude(q)).compare(big_power(k, n) * big_magnitude(p));
+			}
+
+			/**
+			 * @return -1 if <tt>a/b</tt> is below the root by more than the tolerance, 1 if it is above by more
+			 *         than the tolerance, 0 if it is within.
+			 */
+			int locate(long long signed int a, long long signed int b) const {
+				BigInteger k = BigInteger(b) * big_magnitude(tq);
+				BigInteger h = BigInteger(a) * big_magnitude(tq);
+				BigInteger widening = big_magnitude(tp) * b;
+				if (compare(h + widening, k) < 0) return -1;
+				if (compare(h - widening, k) > 0) return 1;
+				return 0;
+			}
+		};
+
+		/**
+		 * The largest <tt>t</tt> in <tt>[1, limit]</tt> for which <tt>(a + t*c) / (b + t*d)</tt> is on
+		 * <tt>side</tt> of the root, knowing that it is for <tt>t = 1</tt>. Gallops, then bisects.
+		 */
+		inline long long signed int root_steps(const RootTarget &target, int side, long long signed int a, long long signed int b,
+		                                       long long signed int c, long long signed int d, long long signed int limit) {
+			long long signed int good = 1;
+			long long signed int bad = limit + 1;
+			while (good <= limit / 2) {
+				long long signed int t = good * 2;
+				if (target.locate(a + t * c, b + t * d) != side) {
+					bad = t;
+					break;
+				}
+				good = t;
+			}
+			while (bad - good > 1) {
+				long long signed int t = good + (bad - good) / 2;
+				if (target.locate(a + t * c, b + t * d) == side) good = t;
+				else bad = t;
+			}
+			return good;
+		}
+
+		/**
+		 * \brief The simplest fraction within the tolerance of the root, or failing that the closest one with a
+		 * denominator of at most <tt>max_den</tt>.
+		 *
+		 * Walks down the Stern-Brocot tree between <tt>lo = a/b</tt> below and <tt>hi = c/d</tt> above the root.
+		 * Each run of steps in the same direction is one term of the root's continued fraction and is found by
+		 * galloping, so the bounds are its convergents and semiconvergents. Once the next mediant would exceed
+		 * <tt>max_den</tt>, every fraction between the bounds does, and the closer bound is the best approximation.
+		 */
+		inline Fraction root_approximation(const RootTarget &target, long long signed int floor, long long signed int max_den) {
+			const long long signed int max_num = 9223372036854775807ll;
+			long long signed int a = floor, b = 1, c = floor + 1, d = 1;
+
+			int lo_side = target.locate(a, b);
+			int hi_side = target.locate(c, d);
+			if (lo_side == 0 || hi_side == 0) {
+				if (lo_side != 0) return Fraction(c, d);
+				if (hi_side != 0) return Fraction(a, b);
+			} else {
+				while (b <= max_den - d && a <= max_num - c) {
+					int side = target.locate(a + c, b + d);
+					if (side == 0) return Fraction(a + c, b + d);
+					if (side < 0) {
+						long long signed int limit = (max_den - b) / d;
+						if (limit > (max_num - a) / c) limit = (max_num - a) / c;
+						long long signed int t = root_steps(target, -1, a, b, c, d, limit);
+						a += t * c;
+						b += t * d;
+					} else {
+						long long signed int limit = (max_den - d) / b;
+						if (a != 0 && limit > (max_num - c) / a) limit = (max_num - c) / a;
+						long long signed int t = root_steps(target, 1, c, d, a, b, limit);
+						c += t * a;
+						d += t * b;
+					}
+				}
+			}
+			// the root is closer to hi if it lies above the midpoint (a/b + c/d) / 2
+			BigInteger midpoint_num = BigInteger(a) * d + BigInteger(c) * b;
+			BigInteger midpoint_den = BigInteger(2) * b * d;
+			RootTarget exact = {target.p, target.q, target.n, 0, 1};
+			if (exact.compare(midpoint_num, midpoint_den) < 0) return Fraction(c, d);
+			return Fraction(a, b);
+		}
+
+		/**
+		 * \brief The <tt>n</tt>th root of <tt>num/den</tt> within <tt>tp/tq</tt>, or the closest one with a
+		 * denominator of at most <tt>max_den</tt>.
+		 *
+		 * Works on the magnitudes and restores the sign at the end, as the roots of <tt>-2^63</tt> and of values
+		 * over <tt>-2^63</tt> fit even though their magnitude does not.
+		 */
+		inline Fraction root(long long signed int num, long long signed int den, unsigned int n,
+		                     unsigned long long int tp, unsigned long long int tq, long long signed int max_den) {
+			if (n == 0 || max_den < 1 || tq == 0) return INVALID_FRACTION;
+			if (num == 0) return Fraction(0);
+			if (n == 1) {
+				if (den < 0 && num != -9223372036854775807ll - 1 && den != -9223372036854775807ll - 1) {
+					num = -num;
+					den = -den;
+				}
+				return Fraction(num, den);
+			}
+			const bool negative = (num < 0) != (den < 0);
+			// only odd roots of negative values are real
+			if (negative && n % 2 == 0) return INVALID_FRACTION;
+			const unsigned long long int p = root_magnitude(num), q = root_magnitude(den);
+
+			unsigned long long int r = integer_root(p, n);
+			unsigned long long int s = integer_root(q, n);
+			// num and den are coprime, so the root is rational exactly if both are perfect powers; n >= 2, so r
+			// and s are below 2^32
+			if (static_cast<long long signed int>(s) <= max_den && is_power(r, n, p) && is_power(s, n, q)) {
+				long long signed int root_num = static_cast<long long signed int>(r);
+				return Fraction(negative ? -root_num : root_num, static_cast<long long signed int>(s));
+			}
+
+			RootTarget target = {p, q, n, tp, tq};
+			long long signed int floor = static_cast<long long signed int>(integer_root(p / q, n));
+			Fraction positive = root_approximation(target, floor, max_den);
+			return (negative && positive.valid()) ? Fraction(-positive.num(), positive.den()) : positive;
+		}
+	}
+
+	/**
+	 * \brief The <tt>n</tt>th root with a denominator of at most <tt>max_denominator</tt>.
+	 *
+	 * Returns the exact root if it is rational and fits, otherwise the closest fraction whose denominator does
+	 * not exceed <tt>max_denominator</tt>. Works on integers only: the integer part comes from Newton's method,
+	 * the fraction from the continued fraction of the root, with each candidate compared exactly against it.
+	 *
+	 * @param n The degree of the root, at least 1.
+	 * @param max_denominator The largest denominator allowed, at least 1.
+	 * @return The root, or an invalid Fraction for even roots of negative values and invalid arguments.
+	 */
+	Fraction Fraction::root(unsigned int n, long long signed int max_denominator) const {
+		if (_invalid) return INVALID_FRACTION;
+		return detail::root(numerator, denominator, n, 0, 1, max_denominator);
+	}
+
+	/**
+	 * \brief The <tt>n</tt>th root within <tt>tolerance</tt>.
+	 *
+	 * Returns the exact root if it is rational, otherwise the fraction with the smallest denominator that is
+	 * no further from the root than <tt>tolerance</tt>. If the tolerance cannot be met within 64 bits, the
+	 * closest fraction that fits is returned.
+	 *
+	 * @param n The degree of the root, at least 1.
+	 * @param tolerance The largest allowed distance from the root.
+	 * @return The root, or an invalid Fraction for even roots of negative values and invalid arguments.
+	 */
+	Fraction Fraction::root(unsigned int n, const Fraction &tolerance) const {
+		if (_invalid || !tolerance.valid()) return INVALID_FRACTION;
+		// only the distance matters, so the signs of the tolerance are dropped
+		return detail::root(numerator, denominator, n, detail::root_magnitude(tolerance.num()),
+		                    detail::root_magnitude(tolerance.den()), 9223372036854775807ll);
+	}
+
+	/**
+	 * The square root, see <tt>root(2, max_denominator)</tt>.
+	 */
+	Fraction Fraction::sqrt(long long signed int max_denominator) const {
+		return root(2, max_denominator);
+	}
+
+	/**
+	 * The square root, see <tt>root(2, tolerance)</tt>.
+	 */
+	Fraction Fraction::sqrt(const Fraction &tolerance) const {
+		return root(2, tolerance);
+	}
+}
@@ -0,0 +1,154 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file group_by.cpp
+ * The code of the FractionGroupBy class.
+ */
+
+#include <algorithm>
+#include <thread>
+
+#ifndef NPASSON_EXPERIMENTAL_COMPILE
+	#include "group_by.hpp"
+#endif
+
+#include "fraction_expression.hpp"
+
+namespace npasson {
+
+	/**
+	 * @param partitions The number of hash partitions, which bounds the useful number of threads.
+	 */
+	FractionGroupBy::FractionGroupBy(std::size_t partitions) : partitions(partitions ? partitions : 1) {}
+
+	/**
+	 * Picks the partition from the upper half of the hash, which the tables themselves hardly use.
+	 *
+	 * @param hash The <tt>FractionMap::hash()</tt> of the key.
+	 */
+	std::size_t FractionGroupBy::partition_of(std::size_t hash) const {
+		return (hash >> (sizeof(std::size_t) * 4)) % partitions.size();
+	}
+
+	void FractionGroupBy::accumulate(FractionAggregate &aggregate, const Fraction &value) {
+		if (aggregate.count == 0) {
+			aggregate.sum = value;
+			aggregate.min = value;
+			aggregate.max = value;
+		} else {
+			aggregate.sum = (lazy(aggregate.sum) + value).eval();
+			if (value.compare(aggregate.min) < 0) aggregate.min = value;
+			if (value.compare(aggregate.max) > 0) aggregate.max = value;
+		}
+		++aggregate.count;
+	}
+
+	/**
+	 * Adds one row.
+	 *
+	 * @param key The group.
+	 * @param value The value to aggregate.
+	 */
+	void FractionGroupBy::add(const Fraction &key, const Fraction &value) {
+		std::size_t hash = FractionMap<FractionAggregate>::hash(key);
+		accumulate(*partitions[partition_of(hash)].insert(key, FractionAggregate(), hash).first, value);
+	}
+
+	/**
+	 * \brief Adds <tt>count</tt> rows, optionally on several threads.
+	 *
+	 * Takes the rows <tt>chunk_rows</tt> at a time, in two passes per chunk. First every thread hashes one
+	 * contiguous share of the chunk and sorts their indices by partition; then every thread aggregates the rows
+	 * of the partitions it owns, in row order and with the hashes from the first pass, so each key is hashed
+	 * once and no locking is needed. The buffers are reused from chunk to chunk, so beside the groups memory
+	 * stays at one chunk. With more threads than partitions the extra threads stay idle in the second pass.
+	 *
+	 * @param keys The group of each row.
+	 * @param values The value of each row.
+	 * @param count The number of rows.
+	 * @param threads The number of threads to use.
+	 */
+	void FractionGroupBy::add(const Fraction* keys, const Fraction* values, std::size_t count, unsigned int threads) {
+		if (threads <= 1 || partitions.size() == 1) {
+			for (std::size_t i = 0; i < count; ++i) add(keys[i], values[i]);
+			return;
+		}
+		struct Row {
+			std::size_t index;
+			std::size_t hash;
+		};
+		// rows[t][p] holds the rows of partition p among the share of thread t in the current chunk
+		std::vector<std::vector<std::vector<Row>>> rows(threads, std::vector<std::vector<Row>>(partitions.size()));
+		const unsigned int owners = (threads > partitions.size()) ? static_cast<unsigned int>(partitions.size()) : threads;
+		std::vector<std::thread> workers;
+
+		for (std::size_t offset = 0; offset < count; offset += chunk_rows) {
+			const std::size_t size = (count - offset < chunk_rows) ? count - offset : chunk_rows;
+			for (unsigned int t = 0; t < threads; ++t) {
+				workers.emplace_back([this, keys, offset, size, threads, t, &rows]() {
+					std::size_t begin = offset + size / threads * t + std::min<std::size_t>(t, size % threads);
+					std::size_t end = begin + size / threads + (t < size % threads ? 1 : 0);
+					for (std::vector<Row> &partition : rows[t]) partition.clear();
+					for (std::size_t i = begin; i < end; ++i) {
+						std::size_t hash = FractionMap<FractionAggregate>::hash(keys[i]);
+						Row row = {i, hash};
+						rows[t][partition_of(hash)].push_back(row);
+					}
+				});
+			}
+			for (std::thread &worker : workers) worker.join();
+			workers.clear();
+
+			for (unsigned int t = 0; t < owners; ++t) {
+				workers.emplace_back([this, keys, values, threads, owners, t, &rows]() {
+					for (std::size_t p = t; p < partitions.size(); p += owners) {
+						for (unsigned int share = 0; share < threads; ++share) {
+							for (const Row &row : rows[share][p]) {
+								FractionAggregate *aggregate = partitions[p].insert(keys[row.index], FractionAggregate(), row.hash).first;
+								accumulate(*aggregate, values[row.index]);
+							}
+						}
+					}
+				});
+			}
+			for (std::thread &worker : workers) worker.join();
+			workers.clear();
+		}
+	}
+
+	/**
+	 * @return The aggregates of <tt>key</tt>, or <tt>nullptr</tt> if no row had that key.
+	 */
+	const FractionAggregate* FractionGroupBy::find(const Fraction &key) const {
+		std::size_t hash = FractionMap<FractionAggregate>::hash(key);
+		return partitions[partition_of(hash)].find(key, hash);
+	}
+
+	/**
+	 * @return The number of groups.
+	 */
+	std::size_t FractionGroupBy::size() const {
+		std::size_t total = 0;
+		for (const FractionMap<FractionAggregate> &partition : partitions) total += partition.size();
+		return total;
+	}
+}
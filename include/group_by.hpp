@@ -0,0 +1,91 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file group_by.hpp
+ * Contains FractionGroupBy, exact hash-based aggregation grouped by Fraction keys.
+ */
+
+#ifndef NPASSON_GROUP_BY_HPP
+#define NPASSON_GROUP_BY_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_map.hpp"
+
+namespace npasson {
+
+	/**
+	 * The aggregates of one group. <tt>sum</tt> turns invalid if it overflows.
+	 */
+	struct FractionAggregate {
+		Fraction sum;
+		Fraction min;
+		Fraction max;
+		unsigned long long int count = 0;
+	};
+
+	/**
+	 * \brief Exact sum, count, min and max per distinct key.
+	 *
+	 * Rows are streamed in one at a time or as arrays, and only one FractionAggregate per distinct key is kept,
+	 * so memory depends on the number of groups and not on the number of rows. Groups are spread over
+	 * partitions by their hash; <tt>add(keys, values, count, threads)</tt> lets each thread own a share of the
+	 * partitions, so threads never touch the same table and nothing needs merging afterwards. It takes the rows
+	 * <tt>chunk_rows</tt> at a time, so its buffers stay bounded too. Rows with an invalid key form one group of
+	 * their own.
+	 */
+	class FractionGroupBy {
+
+	private:
+		std::vector<FractionMap<FractionAggregate>> partitions;
+
+		std::size_t partition_of(std::size_t) const;
+		static void accumulate(FractionAggregate&, const Fraction&);
+
+	public:
+		static const std::size_t chunk_rows = 1 << 16; ///< rows buffered at a time by the threaded add()
+
+		explicit FractionGroupBy(std::size_t partitions = 1);
+
+		void add(const Fraction&, const Fraction&);
+		void add(const Fraction*, const Fraction*, std::size_t, unsigned int threads = 1);
+
+		const FractionAggregate* find(const Fraction&) const;
+		std::size_t size() const;
+
+		/**
+		 * Calls <tt>f(key, aggregate)</tt> for every group, in no particular order.
+		 */
+		template <typename F>
+		void for_each(F f) const {
+			for (const FractionMap<FractionAggregate> &partition : partitions) partition.for_each(f);
+		}
+	};
+}
+
+#ifdef NPASSON_EXPERIMENTAL_COMPILE
+#include "group_by.cpp"
+#endif
+
+#endif //NPASSON_GROUP_BY_HPP
@@ -0,0 +1,268 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file instrumentation.cpp
+ * The code of the Fraction instrumentation counters.
+ */
+
+#include <cstdio>
+#include <mutex>
+
+#ifndef NPASSON_EXPERIMENTAL_COMPILE
+	#include "instrumentation.hpp"
+#endif
+
+namespace npasson {
+
+	namespace detail {
+		thread_local FractionCounters fraction_counters = {};
+
+		namespace {
+			std::mutex exited_counters_mutex;
+			FractionCounters exited_counters = {};
+
+			/**
+			 * Adds the counters of its thread to those of the exited threads when the thread exits.
+			 */
+			struct ExitMerge {
+				~ExitMerge() {
+					std::lock_guard<std::mutex> lock(exited_counters_mutex);
+					exited_counters += fraction_counters;
+				}
+			};
+		}
+
+		/**
+		 * \brief Makes the calling thread add its counters to the totals when it exits.
+		 *
+		 * Called by the hooks on the first construction of each source and the first call of each timed
+		 * operation. The guard is local to this function: at namespace scope, its destructor would give every
+		 * thread_local of this file a TLS initialization call, <tt>fraction_counters</tt> included.
+		 */
+		void register_fraction_counters() {
+			thread_local ExitMerge exit_merge;
+			static_cast<void>(exit_merge);
+		}
+	}
+
+	const char* name(ConstructionSource source) {
+		switch (source) {
+			case ConstructionSource::default_value:      return "default";
+			case ConstructionSource::num_den:            return "num_den";
+			case ConstructionSource::signed_long_long:   return "long_long";
+			case ConstructionSource::unsigned_long_long: return "unsigned_long_long";
+			case ConstructionSource::signed_long:        return "long";
+			case ConstructionSource::unsigned_long:      return "unsigned_long";
+			case ConstructionSource::signed_int:         return "int";
+			case ConstructionSource::unsigned_int:       return "unsigned_int";
+			case ConstructionSource::signed_short:       return "short";
+			case ConstructionSource::unsigned_short:     return "unsigned_short";
+			case ConstructionSource::std_string:         return "string";
+			case ConstructionSource::c_string:           return "c_string";
+			case ConstructionSource::single_float:       return "float";
+			case ConstructionSource::double_float:       return "double";
+			case ConstructionSource::long_double:        return "long_double";
+			case ConstructionSource::boolean:            return "bool";
+			case ConstructionSource::count:              break;
+		}
+		return "";
+	}
+
+	const char* name(FractionOperation op) {
+		switch (op) {
+			case FractionOperation::add:            return "add";
+			case FractionOperation::sub:            return "sub";
+			case FractionOperation::mul:            return "mul";
+			case FractionOperation::div:            return "div";
+			case FractionOperation::equal:          return "equal";
+			case FractionOperation::less:           return "less";
+			case FractionOperation::greater:        return "greater";
+			case FractionOperation::compare:        return "compare";
+			case FractionOperation::compare_double: return "compare_double";
+			case FractionOperation::pow:            return "pow";
+			case FractionOperation::str:            return "str";
+			case FractionOperation::f_str:          return "f_str";
+			case FractionOperation::to_double:      return "to_double";
+			case FractionOperation::count:          break;
+		}
+		return "";
+	}
+
+	void LatencyHistogram::record(unsigned long long int ns) {
+		int bucket = 0;
+		for (unsigned long long int rest = ns >> 1; rest && bucket < buckets - 1; rest >>= 1) ++bucket;
+		++histogram[bucket];
+		++samples;
+		total_ns += ns;
+		if (ns > max_ns) max_ns = ns;
+	}
+
+	/**
+	 * @param fraction A fraction of the samples, e.g. <tt>0.99</tt>.
+	 * @return An upper bound in ns for that fraction of the samples: the upper end of the bucket it is reached in,
+	 * or the longest sample if that is lower. <tt>0</tt> without samples.
+	 */
+	unsigned long long int LatencyHistogram::percentile(double fraction) const {
+		if (samples == 0) return 0;
+		unsigned long long int seen = 0;
+		for (int i = 0; i < buckets; ++i) {
+			seen += histogram[i];
+			if (static_cast<double>(seen) >= fraction * static_cast<double>(samples)) {
+				unsigned long long int upper = (2ull << i) - 1;
+				return (upper < max_ns) ? upper : max_ns;
+			}
+		}
+		return max_ns;
+	}
+
+	FractionCounters& FractionCounters::operator+=(const FractionCounters &rhs) {
+		gcd_calls          += rhs.gcd_calls;
+		gcd_iterations     += rhs.gcd_iterations;
+		gcd_table_lookups  += rhs.gcd_table_lookups;
+		gcd_shifts         += rhs.gcd_shifts;
+		normalizations     += rhs.normalizations;
+		overflows          += rhs.overflows;
+		invalid_created    += rhs.invalid_created;
+		invalid_operands   += rhs.invalid_operands;
+		string_conversions += rhs.string_conversions;
+		for (int i = 0; i < static_cast<int>(ConstructionSource::count); ++i) constructions[i] += rhs.constructions[i];
+		for (int i = 0; i < static_cast<int>(FractionOperation::count); ++i) {
+			LatencyHistogram &lhs_latency = latency[i];
+			const LatencyHistogram &rhs_latency = rhs.latency[i];
+			lhs_latency.calls    += rhs_latency.calls;
+			lhs_latency.samples  += rhs_latency.samples;
+			lhs_latency.total_ns += rhs_latency.total_ns;
+			if (rhs_latency.max_ns > lhs_latency.max_ns) lhs_latency.max_ns = rhs_latency.max_ns;
+			for (int b = 0; b < LatencyHistogram::buckets; ++b) lhs_latency.histogram[b] += rhs_latency.histogram[b];
+		}
+		return *this;
+	}
+
+	/**
+	 * \brief Returns a human readable report.
+	 *
+	 * Constructions and operations that never happened are left out.
+	 */
+	std::string FractionCounters::text() const {
+		char line[160];
+		std::string result;
+		std::snprintf(line, sizeof(line), "gcd: %llu calls, %llu iterations, %llu table lookups, %llu shifts\n",
+		              gcd_calls, gcd_iterations, gcd_table_lookups, gcd_shifts);
+		result += line;
+		std::snprintf(line, sizeof(line), "normalizations: %llu, overflows: %llu, invalid: %llu created, %llu operands\n",
+		              normalizations, overflows, invalid_created, invalid_operands);
+		result += line;
+		std::snprintf(line, sizeof(line), "hidden string conversions: %llu\n", string_conversions);
+		result += line;
+		result += "constructions:";
+		for (int i = 0; i < static_cast<int>(ConstructionSource::count); ++i) {
+			if (!constructions[i]) continue;
+			std::snprintf(line, sizeof(line), " %s %llu", name(static_cast<ConstructionSource>(i)), constructions[i]);
+			result += line;
+		}
+		std::snprintf(line, sizeof(line), "\nlatency (1 in %d calls timed):\n", NPASSON_INSTRUMENT_SAMPLE_RATE);
+		result += line;
+		for (int i = 0; i < static_cast<int>(FractionOperation::count); ++i) {
+			const LatencyHistogram &h = latency[i];
+			if (!h.calls) continue;
+			std::snprintf(line, sizeof(line), "  %-15s calls %llu, samples %llu, mean %.1f ns, p50 %llu ns, p99 %llu ns, max %llu ns\n",
+			              name(static_cast<FractionOperation>(i)), h.calls, h.samples,
+			              h.samples ? static_cast<double>(h.total_ns) / static_cast<double>(h.samples) : 0.0,
+			              h.percentile(0.5), h.percentile(0.99), h.max_ns);
+			result += line;
+		}
+		return result;
+	}
+
+	/**
+	 * \brief Returns every counter as one JSON object.
+	 *
+	 * Histograms list their buckets up to the last non-empty one; bucket <tt>i</tt> covers
+	 * <tt>[2^i, 2^(i+1))</tt> ns.
+	 */
+	std::string FractionCounters::json() const {
+		char field[96];
+		std::string result = "{";
+		std::snprintf(field, sizeof(field), "\"sample_rate\": %d, ", NPASSON_INSTRUMENT_SAMPLE_RATE);
+		result += field;
+		std::snprintf(field, sizeof(field), "\"gcd\": {\"calls\": %llu, \"iterations\": %llu, ", gcd_calls, gcd_iterations);
+		result += field;
+		std::snprintf(field, sizeof(field), "\"table_lookups\": %llu, \"shifts\": %llu}, ", gcd_table_lookups, gcd_shifts);
+		result += field;
+		std::snprintf(field, sizeof(field), "\"normalizations\": %llu, \"overflows\": %llu, ", normalizations, overflows);
+		result += field;
+		std::snprintf(field, sizeof(field), "\"invalid_created\": %llu, \"invalid_operands\": %llu, ",
+		              invalid_created, invalid_operands);
+		result += field;
+		std::snprintf(field, sizeof(field), "\"string_conversions\": %llu, \"constructions\": {", string_conversions);
+		result += field;
+		for (int i = 0; i < static_cast<int>(ConstructionSource::count); ++i) {
+			std::snprintf(field, sizeof(field), "%s\"%s\": %llu", i ? ", " : "", name(static_cast<ConstructionSource>(i)),
+			              constructions[i]);
+			result += field;
+		}
+		result += "}, \"latency\": {";
+		for (int i = 0; i < static_cast<int>(FractionOperation::count); ++i) {
+			const LatencyHistogram &h = latency[i];
+			std::snprintf(field, sizeof(field), "%s\"%s\": {\"calls\": %llu, \"samples\": %llu, ", i ? ", " : "",
+			              name(static_cast<FractionOperation>(i)), h.calls, h.samples);
+			result += field;
+			std::snprintf(field, sizeof(field), "\"total_ns\": %llu, \"max_ns\": %llu, \"histogram\": [", h.total_ns, h.max_ns);
+			result += field;
+			int used = LatencyHistogram::buckets;
+			while (used > 0 && !h.histogram[used - 1]) --used;
+			for (int b = 0; b < used; ++b) {
+				std::snprintf(field, sizeof(field), "%s%llu", b ? ", " : "", h.histogram[b]);
+				result += field;
+			}
+			result += "]}";
+		}
+		return result + "}}";
+	}
+
+	/**
+	 * @return The counters of the calling thread.
+	 */
+	FractionCounters fraction_counters() {
+		return detail::fraction_counters;
+	}
+
+	/**
+	 * \brief Returns the counters of the calling thread plus those of every thread that has exited.
+	 *
+	 * Threads still running are left out, since their counters are written without synchronization; join them first.
+	 */
+	FractionCounters all_fraction_counters() {
+		FractionCounters result = fraction_counters();
+		std::lock_guard<std::mutex> lock(detail::exited_counters_mutex);
+		return result += detail::exited_counters;
+	}
+
+	/**
+	 * Zeroes the counters of the calling thread and those of the exited threads.
+	 */
+	void reset_fraction_counters() {
+		detail::fraction_counters = FractionCounters();
+		std::lock_guard<std::mutex> lock(detail::exited_counters_mutex);
+		detail::exited_counters = FractionCounters();
+	}
+}
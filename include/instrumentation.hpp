@@ -0,0 +1,229 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file instrumentation.hpp
+ * Contains the optional counters and latency histograms of the Fraction hot paths.
+ *
+ * Everything here is compiled in only with <tt>NPASSON_INSTRUMENT</tt> defined, for <tt>fraction.cpp</tt> as well
+ * as the code reading the counters. Without it the hooks expand to nothing and the counters stay zero.
+ */
+
+#ifndef NPASSON_INSTRUMENTATION_HPP
+#define NPASSON_INSTRUMENTATION_HPP
+
+#include <chrono>
+#include <string>
+
+// one call in this many is timed per operation and thread; a power of two
+#ifndef NPASSON_INSTRUMENT_SAMPLE_RATE
+#define NPASSON_INSTRUMENT_SAMPLE_RATE 64
+#endif
+
+namespace npasson {
+
+	static_assert(NPASSON_INSTRUMENT_SAMPLE_RATE > 0
+	              && (NPASSON_INSTRUMENT_SAMPLE_RATE & (NPASSON_INSTRUMENT_SAMPLE_RATE - 1)) == 0,
+	              "Error: NPASSON_INSTRUMENT_SAMPLE_RATE must be a power of two");
+
+	/**
+	 * The constructor a Fraction came from. Constructions inside the operators count as <tt>num_den</tt>.
+	 */
+	enum class ConstructionSource {
+		default_value,
+		num_den,
+		signed_long_long,
+		unsigned_long_long,
+		signed_long,
+		unsigned_long,
+		signed_int,
+		unsigned_int,
+		signed_short,
+		unsigned_short,
+		std_string,
+		c_string,
+		single_float,
+		double_float,
+		long_double,
+		boolean,
+		count
+	};
+
+	/**
+	 * The operations with latency histograms. The plain operators are timed through their compound forms.
+	 */
+	enum class FractionOperation {
+		add,
+		sub,
+		mul,
+		div,
+		equal,
+		less,
+		greater,
+		compare,
+		compare_double,
+		pow,
+		str,
+		f_str,
+		to_double,
+		count
+	};
+
+	const char* name(ConstructionSource);
+	const char* name(FractionOperation);
+
+	/**
+	 * \brief Sampled latencies of one operation, in power of two buckets.
+	 *
+	 * Bucket <tt>i</tt> holds samples of <tt>[2^i, 2^(i+1))</tt> nanoseconds, bucket 0 also those below 1 ns.
+	 */
+	struct LatencyHistogram {
+		static const int buckets = 40;
+
+		unsigned long long int calls;              ///< calls, sampled or not
+		unsigned long long int samples;            ///< calls that were timed
+		unsigned long long int total_ns;           ///< sum of the sampled latencies
+		unsigned long long int max_ns;             ///< longest sampled latency
+		unsigned long long int histogram[buckets]; ///< sampled latencies by bucket
+
+		void record(unsigned long long int);
+		unsigned long long int percentile(double) const;
+	};
+
+	/**
+	 * \brief The instrumentation counters of one thread.
+	 *
+	 * Counts are since the thread started or since the last <tt>reset_fraction_counters()</tt>. When a thread exits,
+	 * its counters are added to those of the exited threads, which <tt>all_fraction_counters()</tt> includes.
+	 */
+	struct FractionCounters {
+		unsigned long long int gcd_calls;                  ///< runs of Euclid's algorithm
+		unsigned long long int gcd_iterations;             ///< division steps in those runs
+		unsigned long long int gcd_table_lookups;          ///< reductions by the gcd table
+		unsigned long long int gcd_shifts;                 ///< reductions of power of two denominators by shifting
+		unsigned long long int normalizations;             ///< constructions that actually reduced their operands
+		unsigned long long int overflows;                  ///< intermediates of + - * / < > and lcm() that left the 64 bit range
+		unsigned long long int invalid_created;            ///< constructions that produced an invalid Fraction
+		unsigned long long int invalid_operands;           ///< operations with an invalid operand
+		unsigned long long int string_conversions;         ///< hidden number to string round trips in constructors
+		unsigned long long int constructions[static_cast<int>(ConstructionSource::count)];
+		LatencyHistogram       latency[static_cast<int>(FractionOperation::count)];
+
+		FractionCounters& operator+=(const FractionCounters&);
+
+		std::string text() const;
+		std::string json() const;
+	};
+
+	FractionCounters fraction_counters();
+	FractionCounters all_fraction_counters();
+	void reset_fraction_counters();
+
+	namespace detail {
+		// plain data, so that the hooks reach it without a TLS initialization call
+		extern thread_local FractionCounters fraction_counters;
+
+		void register_fraction_counters();
+
+		/**
+		 * Times the enclosing scope if its call is picked by the sample rate.
+		 */
+		class OperationTimer {
+
+		private:
+			LatencyHistogram *target = nullptr;
+			std::chrono::steady_clock::time_point start;
+
+		public:
+			explicit OperationTimer(FractionOperation op) {
+				LatencyHistogram &histogram = fraction_counters.latency[static_cast<int>(op)];
+				if ((histogram.calls++ & (NPASSON_INSTRUMENT_SAMPLE_RATE - 1)) == 0) {
+					if (histogram.calls == 1) register_fraction_counters();
+					target = &histogram;
+					start = std::chrono::steady_clock::now();
+				}
+			}
+			OperationTimer(const OperationTimer&) = delete;
+			OperationTimer& operator=(const OperationTimer&) = delete;
+
+			~OperationTimer() {
+				if (target) {
+					std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+					target->record(static_cast<unsigned long long int>(elapsed.count()));
+				}
+			}
+		};
+
+		/**
+		 * @return If <tt>a * b</tt> does not fit in 64 bits.
+		 */
+		inline bool product_overflows(long long signed int a, long long signed int b) {
+#if defined(__GNUC__) || defined(__clang__)
+			long long signed int result;
+			return __builtin_mul_overflow(a, b, &result);
+#else
+			const long long signed int max = 9223372036854775807ll, min = -max - 1;
+			if (a == 0 || b == 0) return false;
+			if ((a > 0) == (b > 0)) return (a > 0) ? (a > max / b) : (a < max / b);
+			return (a > 0) ? (b < min / a) : (a < min / b);
+#endif
+		}
+
+		/**
+		 * @return If <tt>a * b + c * d</tt>, or <tt>a * b - c * d</tt>, leaves the 64 bit range on the way.
+		 */
+		inline bool sum_of_products_overflows(long long signed int a, long long signed int b,
+		                                      long long signed int c, long long signed int d, bool subtract) {
+			const long long signed int max = 9223372036854775807ll, min = -max - 1;
+			if (product_overflows(a, b) || product_overflows(c, d)) return true;
+			long long signed int x = a * b, y = c * d;
+			if (subtract) return (y < 0) ? (x > max + y) : (x < min + y);
+			return (y > 0) ? (x > max - y) : (x < min - y);
+		}
+	}
+}
+
+#ifdef NPASSON_INSTRUMENT
+	#define NPASSON_COUNT(counter) (++::npasson::detail::fraction_counters.counter)
+	#define NPASSON_COUNT_IF(condition, counter) do {                                                                \
+		if (condition) ++::npasson::detail::fraction_counters.counter;                                               \
+	} while (false)
+	#define NPASSON_COUNT_ADD(counter, amount) (::npasson::detail::fraction_counters.counter += (amount))
+	// the first construction of each source in a thread, a cold path, registers the thread for the exit merge
+	#define NPASSON_COUNT_SOURCE(source) do {                                                                        \
+		if (::npasson::detail::fraction_counters.constructions[static_cast<int>(::npasson::ConstructionSource::source)]++ == 0) \
+			::npasson::detail::register_fraction_counters();                                                         \
+	} while (false)
+	#define NPASSON_TIME(operation) \
+		::npasson::detail::OperationTimer npasson_operation_timer(::npasson::FractionOperation::operation)
+#else
+	#define NPASSON_COUNT(counter) ((void)0)
+	#define NPASSON_COUNT_IF(condition, counter) ((void)0)
+	#define NPASSON_COUNT_ADD(counter, amount) ((void)(amount))
+	#define NPASSON_COUNT_SOURCE(source) ((void)0)
+	#define NPASSON_TIME(operation) ((void)0)
+#endif
+
+#ifdef NPASSON_EXPERIMENTAL_COMPILE
+#include "instrumentation.cpp"
+#endif
+
+#endif //NPASSON_INSTRUMENTATION_HPP
@@ -0,0 +1,376 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file lattice.cpp
+ * The code of the Lattice class.
+ */
+
+#include <cmath>
+#include <utility>
+
+#ifndef NPASSON_EXPERIMENTAL_COMPILE
+	#include "lattice.hpp"
+#endif
+
+namespace npasson {
+
+	namespace detail {
+
+		inline BigInteger lattice_dot(const std::vector<BigInteger> &a, const std::vector<BigInteger> &b) {
+			BigInteger result(0);
+			for (std::size_t i = 0; i < a.size() && i < b.size(); ++i) result += a[i] * b[i];
+			return result;
+		}
+
+		/**
+		 * <tt>a -= q * b</tt>
+		 */
+		inline void lattice_sub(std::vector<BigInteger> &a, const BigInteger &q, const std::vector<BigInteger> &b) {
+			for (std::size_t i = 0; i < a.size() && i < b.size(); ++i) a[i] -= q * b[i];
+		}
+
+		/**
+		 * \brief The integral Gram-Schmidt data of a basis, updated in place as the basis changes.
+		 *
+		 * Indices are those of the rows; <tt>d[i + 1]</tt> belongs to row <tt>i</tt> and <tt>d[0] = 1</tt>.
+		 */
+		struct IntegralGramSchmidt {
+			std::vector<BigInteger> d;
+			std::vector<std::vector<BigInteger>> lambda;
+			std::size_t known = 0;
+
+			explicit IntegralGramSchmidt(std::size_t n) : d(n + 1, BigInteger(0)), lambda(n, std::vector<BigInteger>(n)) {
+				d[0] = 1;
+			}
+
+			/**
+			 * Adds row <tt>k</tt>, the next one without data, from the rows before it.
+			 *
+			 * @return <tt>false</tt> if it depends linearly on them.
+			 */
+			bool extend(const std::vector<std::vector<BigInteger>> &rows, std::size_t k) {
+				for (std::size_t j = 0; j <= k; ++j) {
+					BigInteger u = lattice_dot(rows[k], rows[j]);
+					for (std::size_t i = 0; i < j; ++i) u = (d[i + 1] * u - lambda[k][i] * lambda[j][i]) / d[i];
+					if (j < k) lambda[k][j] = std::move(u);
+					else d[k + 1] = std::move(u);
+				}
+				known = k + 1;
+				return !d[k + 1].is_zero();
+			}
+
+			/**
+			 * \brief Size-reduces row <tt>k</tt> against row <tt>l</tt>, so that <tt>|mu_kl| <= 1/2</tt>.
+			 */
+			void reduce(std::vector<std::vector<BigInteger>> &rows, std::size_t k, std::size_t l) {
+				BigInteger twice = lambda[k][l] * 2;
+				if (twice.sign() < 0) twice = -twice;
+				if (twice <= d[l + 1]) return;
+				// the nearest integer to lambda / d
+				BigInteger q = BigInteger::floor_divide(lambda[k][l] * 2 + d[l + 1], d[l + 1] * 2);
+				lattice_sub(rows[k], q, rows[l]);
+				lambda[k][l] -= q * d[l + 1];
+				for (std::size_t i = 0; i < l; ++i) lambda[k][i] -= q * lambda[l][i];
+			}
+
+			/**
+			 * \brief Swaps rows <tt>k - 1</tt> and <tt>k</tt> and updates the data of the rows after them, instead
+			 * of computing it anew.
+			 */
+			void swap(std::vector<std::vector<BigInteger>> &rows, std::size_t k) {
+				std::swap(rows[k], rows[k - 1]);
+				for (std::size_t j = 0; j + 1 < k; ++j) std::swap(lambda[k][j], lambda[k - 1][j]);
+				BigInteger l = lambda[k][k - 1];
+				BigInteger b = (d[k - 1] * d[k + 1] + l * l) / d[k];
+				for (std::size_t i = k + 1; i < known; ++i) {
+					BigInteger t = lambda[i][k];
+					lambda[i][k] = (d[k + 1] * lambda[i][k - 1] - l * t) / d[k];
+					lambda[i][k - 1] = (b * t + l * lambda[i][k]) / d[k + 1];
+				}
+				d[k] = std::move(b);
+			}
+
+			/**
+			 * The Lovász condition for rows <tt>k - 1</tt> and <tt>k</tt>,
+			 * <tt>|b*_k|^2 >= (delta - mu^2) |b*_(k-1)|^2</tt>, multiplied out.
+			 */
+			bool lovasz(std::size_t k, const BigInteger &delta_num, const BigInteger &delta_den) const {
+				const BigInteger &l = lambda[k][k - 1];
+				return delta_den * (d[k + 1] * d[k - 1] + l * l) >= delta_num * d[k] * d[k];
+			}
+		};
+
+		/**
+		 * The integral <tt>double</tt> <tt>q</tt> as a BigInteger.
+		 */
+		inline BigInteger lattice_integer(double q) {
+			if (std::fabs(q) < 9.0e18) return BigInteger(static_cast<long long signed int>(q));
+			int exponent;
+			double mantissa = std::frexp(q, &exponent);
+			BigInteger result(static_cast<long long signed int>(std::ldexp(mantissa, 53)));
+			for (exponent -= 53; exponent > 0; exponent -= 30) {
+				result *= BigInteger(1ll << (exponent < 30 ? exponent : 30));
+			}
+			return result;
+		}
+
+		inline bool lattice_delta_valid(const Fraction &delta) {
+			// 1/4 < delta <= 1
+			return delta.valid() && delta.compare(Fraction(1, 4)) > 0 && delta.compare(Fraction(1)) <= 0;
+		}
+	}
+
+	/**
+	 * Creates a lattice from the rows of <tt>basis</tt>.
+	 */
+	Lattice::Lattice(const std::vector<std::vector<long long signed int>> &basis) {
+		for (const std::vector<long long signed int> &row : basis) rows.push_back(std::vector<BigInteger>(row.begin(), row.end()));
+	}
+
+	/**
+	 * Creates a lattice from the rows of <tt>basis</tt>.
+	 */
+	Lattice::Lattice(std::vector<std::vector<BigInteger>> basis) : rows(std::move(basis)) {}
+
+	/**
+	 * \brief Creates a lattice from rational rows, scaled to integers by the common denominator of all entries.
+	 *
+	 * The common denominator is kept as a BigInteger, so it may exceed the range of the entries. If any entry is
+	 * invalid, the basis is left empty.
+	 *
+	 * @param basis The rows.
+	 * \sa scale()
+	 */
+	Lattice::Lattice(const std::vector<std::vector<Fraction>> &basis) {
+		for (const std::vector<Fraction> &row : basis) {
+			for (const Fraction &entry : row) {
+				if (!entry.valid()) return;
+				// invert(Fraction&) may leave a negative denominator behind
+				BigInteger den = (entry.den() < 0) ? -BigInteger(entry.den()) : BigInteger(entry.den());
+				BigInteger a = common_denominator, b = den, t;
+				while (!b.is_zero()) {
+					t = a % b;
+					a = std::move(b);
+					b = std::move(t);
+				}
+				common_denominator = common_denominator / a * den;
+			}
+		}
+		for (const std::vector<Fraction> &row : basis) {
+			std::vector<BigInteger> scaled;
+			for (const Fraction &entry : row) {
+				BigInteger num(entry.num()), den(entry.den());
+				if (den.sign() < 0) {
+					num = -num;
+					den = -den;
+				}
+				scaled.push_back(num * (common_denominator / den));
+			}
+			rows.push_back(std::move(scaled));
+		}
+	}
+
+	/**
+	 * Creates a lattice from a braced list of rows, e.g. <tt>Lattice({{1, 0}, {3, 4}})</tt>.
+	 */
+	Lattice::Lattice(std::initializer_list<std::initializer_list<long long signed int>> basis) {
+		for (const std::initializer_list<long long signed int> &row : basis) rows.push_back(std::vector<BigInteger>(row.begin(), row.end()));
+	}
+
+	/**
+	 * \brief The exact Gram-Schmidt data of the basis in integral form.
+	 *
+	 * @param d Receives <tt>d_0 = 1</tt> and the Gram determinants <tt>d_1 ... d_n</tt>.
+	 * @param lambda Receives <tt>lambda_ij = d_(j+1) * mu_ij</tt> for <tt>j < i</tt>.
+	 * @return <tt>false</tt> if the rows are linearly dependent.
+	 */
+	bool Lattice::gram_schmidt(std::vector<BigInteger> &d, std::vector<std::vector<BigInteger>> &lambda) const {
+		detail::IntegralGramSchmidt data(rows.size());
+		for (std::size_t k = 0; k < rows.size(); ++k) {
+			if (!data.extend(rows, k)) return false;
+		}
+		d = std::move(data.d);
+		lambda = std::move(data.lambda);
+		return true;
+	}
+
+	/**
+	 * \brief Checks exactly whether the basis is LLL-reduced.
+	 *
+	 * That is, size-reduced, <tt>|mu_ij| <= 1/2</tt>, and satisfying the Lovász condition for every pair of
+	 * neighbouring rows.
+	 */
+	bool Lattice::is_reduced(const Fraction &delta) const {
+		std::vector<BigInteger> d;
+		std::vector<std::vector<BigInteger>> lambda;
+		if (!detail::lattice_delta_valid(delta) || !gram_schmidt(d, lambda)) return false;
+		detail::IntegralGramSchmidt data(rows.size());
+		data.d = std::move(d);
+		data.lambda = std::move(lambda);
+		data.known = rows.size();
+		BigInteger delta_num(delta.num()), delta_den(delta.den());
+		for (std::size_t k = 0; k < rows.size(); ++k) {
+			for (std::size_t j = 0; j < k; ++j) {
+				BigInteger twice = data.lambda[k][j] * 2;
+				if (twice.sign() < 0) twice = -twice;
+				if (twice > data.d[j + 1]) return false;
+			}
+			if (k > 0 && !data.lovasz(k, delta_num, delta_den)) return false;
+		}
+		return true;
+	}
+
+	/**
+	 * \brief Reduces the basis with the exact integral LLL algorithm.
+	 *
+	 * The Gram-Schmidt data of a row is computed once, when the algorithm first reaches it, and from then on
+	 * only updated by size reductions and swaps. All arithmetic is exact on arbitrary precision integers.
+	 *
+	 * @param delta The Lovász parameter, <tt>1/4 < delta <= 1</tt>.
+	 * @param swaps If not null, receives the number of swaps made.
+	 * @return <tt>false</tt>, leaving the basis partly reduced, if the rows are linearly dependent or
+	 *         <tt>delta</tt> is out of range.
+	 */
+	bool Lattice::lll(const Fraction &delta, std::size_t* swaps) {
+		if (swaps) *swaps = 0;
+		if (!detail::lattice_delta_valid(delta)) return false;
+		const std::size_t n = rows.size();
+		if (n == 0) return true;
+
+		BigInteger delta_num(delta.num()), delta_den(delta.den());
+		detail::IntegralGramSchmidt data(n);
+		if (!data.extend(rows, 0)) return false;
+		std::size_t k = 1;
+		while (k < n) {
+			if (k >= data.known && !data.extend(rows, k)) return false;
+			data.reduce(rows, k, k - 1);
+			if (!data.lovasz(k, delta_num, delta_den)) {
+				data.swap(rows, k);
+				if (swaps) ++*swaps;
+				if (k > 1) --k;
+				continue;
+			}
+			for (std::size_t l = k - 1; l-- > 0; ) data.reduce(rows, k, l);
+			++k;
+		}
+		return true;
+	}
+
+	/**
+	 * \brief LLL with a floating point guide, verified exactly.
+	 *
+	 * A first pass works on <tt>double</tt> Gram-Schmidt data, recomputed for one row at a time the way
+	 * Schnorr and Euchner do, while applying every reduction and swap exactly to the integer basis. Dot products
+	 * that cancel too much in <tt>double</tt> are taken exactly instead. The exact
+	 * algorithm then runs on its result: on a reduced basis it only computes the Gram-Schmidt data once and
+	 * finds nothing to do, and whatever rounding errors left behind is repaired. The result is therefore
+	 * always exactly reduced.
+	 *
+	 * The pass is skipped if the entries do not fit a <tt>double</tt>.
+	 *
+	 * @param delta The Lovász parameter, <tt>1/4 < delta <= 1</tt>.
+	 * @param swaps If not null, receives the number of swaps the exact pass still had to make.
+	 * @return <tt>false</tt> if the rows are linearly dependent or <tt>delta</tt> is out of range.
+	 */
+	bool Lattice::lll_guided(const Fraction &delta, std::size_t* swaps) {
+		if (swaps) *swaps = 0;
+		if (!detail::lattice_delta_valid(delta)) return false;
+		const std::size_t n = rows.size();
+		// generous, the exact pass finishes whatever is left
+		float_pass(delta, 64 + 16 * n * n);
+		return lll(delta, swaps);
+	}
+
+	/**
+	 * The floating point pass of <tt>lll_guided()</tt>, giving up after <tt>max_steps</tt> steps.
+	 *
+	 * @return <tt>false</tt> if it gave up or could not start.
+	 */
+	bool Lattice::float_pass(const Fraction &delta, std::size_t max_steps) {
+		const std::size_t n = rows.size();
+		if (n < 2) return true;
+		const double delta_value = delta.to_double();
+
+		std::vector<std::vector<double>> approx(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			for (const BigInteger &x : rows[i]) {
+				double value = x.to_double();
+				if (!(std::fabs(value) < 1e150)) return false;
+				approx[i].push_back(value);
+			}
+		}
+		auto dot = [](const std::vector<double> &a, const std::vector<double> &b) {
+			double result = 0;
+			for (std::size_t i = 0; i < a.size() && i < b.size(); ++i) result += a[i] * b[i];
+			return result;
+		};
+
+		// b_norm[i] = |b*_i|^2, r[i][j] = mu_ij * |b*_j|^2
+		std::vector<double> b_norm(n), norm(n);
+		std::vector<std::vector<double>> mu(n, std::vector<double>(n)), r(n, std::vector<double>(n));
+		b_norm[0] = norm[0] = dot(approx[0], approx[0]);
+		std::size_t k = 1;
+		for (std::size_t step = 0; k < n; ++step) {
+			if (step >= max_steps) return false;
+
+			// recompute row k and size-reduce it until it stays put, each round fixing what rounding spoilt
+			for (int round = 0; round < 8; ++round) {
+				norm[k] = dot(approx[k], approx[k]);
+				for (std::size_t j = 0; j < k; ++j) {
+					r[k][j] = dot(approx[k], approx[j]);
+					if (r[k][j] * r[k][j] < 1.4210854715202004e-14 * norm[k] * norm[j]) { // 2^-46
+						// too much cancellation for doubles, take the exact value
+						r[k][j] = detail::lattice_dot(rows[k], rows[j]).to_double();
+					}
+					for (std::size_t i = 0; i < j; ++i) r[k][j] -= mu[j][i] * r[k][i];
+					mu[k][j] = r[k][j] / b_norm[j];
+				}
+				bool changed = false;
+				for (std::size_t j = k; j-- > 0; ) {
+					// a little slack, rounding errors would otherwise make rows near 1/2 flip forever
+					if (std::fabs(mu[k][j]) <= 0.51) continue;
+					double q = std::floor(mu[k][j] + 0.5);
+					changed = true;
+					detail::lattice_sub(rows[k], detail::lattice_integer(q), rows[j]);
+					for (std::size_t i = 0; i < approx[k].size(); ++i) approx[k][i] = rows[k][i].to_double();
+					for (std::size_t i = 0; i < j; ++i) mu[k][i] -= q * mu[j][i];
+					mu[k][j] -= q;
+				}
+				if (!changed) break;
+			}
+			norm[k] = dot(approx[k], approx[k]);
+			b_norm[k] = norm[k];
+			for (std::size_t j = 0; j < k; ++j) b_norm[k] -= mu[k][j] * r[k][j];
+
+			if (delta_value * b_norm[k - 1] > b_norm[k] + mu[k][k - 1] * mu[k][k - 1] * b_norm[k - 1]) {
+				std::swap(rows[k], rows[k - 1]);
+				std::swap(approx[k], approx[k - 1]);
+				std::swap(norm[k], norm[k - 1]);
+				if (k > 1) --k;
+				else b_norm[0] = norm[0];
+			} else {
+				++k;
+			}
+		}
+		return true;
+	}
+}
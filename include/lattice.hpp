@@ -0,0 +1,81 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file lattice.hpp
+ * Contains Lattice, exact LLL reduction of integer lattice bases.
+ */
+
+#ifndef NPASSON_LATTICE_HPP
+#define NPASSON_LATTICE_HPP
+
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+#include "big_integer.hpp"
+#include "fraction.hpp"
+
+namespace npasson {
+
+	/**
+	 * \brief A lattice given by a basis of integer row vectors, with exact LLL reduction.
+	 *
+	 * The Gram-Schmidt data is kept in integral form: <tt>d_i</tt>, the Gram determinant of the first
+	 * <tt>i</tt> rows, and <tt>lambda_ij = d_(j+1) * mu_ij</tt> for the 0-indexed rows <tt>j < i</tt>. Both are
+	 * integers, so no rational is ever reduced, and every update divides exactly.
+	 * <tt>|b*_i|^2 = d_(i+1) / d_i</tt> with <tt>d_0 = 1</tt>.
+	 *
+	 * A basis with Fraction entries is scaled to integers by the common denominator of all entries, which scales
+	 * the lattice without changing which bases are reduced; <tt>scale()</tt> returns that factor, so the rows of
+	 * <tt>basis()</tt> divided by it are the reduced rational basis.
+	 */
+	class Lattice {
+
+	private:
+		std::vector<std::vector<BigInteger>> rows;
+		BigInteger common_denominator = 1;
+
+		bool float_pass(const Fraction&, std::size_t);
+
+	public:
+		explicit Lattice(const std::vector<std::vector<long long signed int>>&);
+		explicit Lattice(std::vector<std::vector<BigInteger>>);
+		explicit Lattice(const std::vector<std::vector<Fraction>>&);
+		Lattice(std::initializer_list<std::initializer_list<long long signed int>>);
+
+		const std::vector<std::vector<BigInteger>>& basis() const {return rows;}
+		std::size_t size() const {return rows.size();}
+		const BigInteger& scale() const {return common_denominator;}
+
+		bool gram_schmidt(std::vector<BigInteger>&, std::vector<std::vector<BigInteger>>&) const;
+		bool is_reduced(const Fraction& = Fraction(3, 4)) const;
+
+		bool lll(const Fraction& = Fraction(3, 4), std::size_t* = nullptr);
+		bool lll_guided(const Fraction& = Fraction(3, 4), std::size_t* = nullptr);
+	};
+}
+
+#ifdef NPASSON_EXPERIMENTAL_COMPILE
+#include "lattice.cpp"
+#endif
+
+#endif //NPASSON_LATTICE_HPP
@@ -0,0 +1,330 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file predicates.cpp
+ * The code of the geometric predicates.
+ *
+ * Every predicate runs in up to three stages. The determinant is first evaluated in <tt>double</tt> and accepted
+ * if it is farther from zero than a bound on its rounding error, which includes rounding the coordinates
+ * themselves. Otherwise the same determinant is evaluated exactly on integers: every row of differences is
+ * brought to a common denominator, which scales the determinant by a positive factor and so keeps its sign. That
+ * exact evaluation is tried in 128 bit arithmetic with overflow checks, and redone with BigInteger if it
+ * overflows.
+ */
+
+#include <cmath>
+
+#ifndef NPASSON_EXPERIMENTAL_COMPILE
+	#include "predicates.hpp"
+#endif
+
+#include "big_integer.hpp"
+
+namespace npasson {
+
+	namespace detail {
+
+#if defined(__SIZEOF_INT128__)
+		/**
+		 * A 128 bit integer that remembers if any operation leading to it overflowed.
+		 */
+		struct Checked128 {
+			__int128 value = 0;
+			bool overflow = false;
+
+			Checked128() = default;
+			Checked128(long long signed int value) : value(value) {} // NOLINT
+
+			Checked128 operator+(const Checked128 &rhs) const {
+				Checked128 result;
+				result.overflow = overflow || rhs.overflow || __builtin_add_overflow(value, rhs.value, &result.value);
+				return result;
+			}
+			Checked128 operator-(const Checked128 &rhs) const {
+				Checked128 result;
+				result.overflow = overflow || rhs.overflow || __builtin_sub_overflow(value, rhs.value, &result.value);
+				return result;
+			}
+			Checked128 operator*(const Checked128 &rhs) const {
+				Checked128 result;
+				result.overflow = overflow || rhs.overflow || __builtin_mul_overflow(value, rhs.value, &result.value);
+				return result;
+			}
+			Checked128 operator-() const {
+				return Checked128(0) - (*this);
+			}
+			bool operator==(const Checked128 &rhs) const {return value == rhs.value;}
+			int  sign() const {return (value > 0) - (value < 0);}
+		};
+
+		inline bool overflowed(const Checked128 &value) {return value.overflow;}
+#endif
+
+		inline bool overflowed(const BigInteger&) {return false;}
+
+		/**
+		 * A rational number <tt>p/q</tt> with <tt>q > 0</tt>, not necessarily reduced.
+		 */
+		template <typename Ring>
+		struct Rational {
+			Ring p;
+			Ring q;
+		};
+
+		/**
+		 * Returns <tt>a - b</tt> exactly. Equal denominators, i.e. integer or fixed point coordinates, are not
+		 * multiplied up.
+		 */
+		template <typename Ring>
+		Rational<Ring> difference(const Fraction &a, const Fraction &b) {
+			// invert(Fraction&) may leave a negative denominator behind
+			Ring an = (a.den() < 0) ? -Ring(a.num()) : Ring(a.num());
+			Ring ad = (a.den() < 0) ? -Ring(a.den()) : Ring(a.den());
+			Ring bn = (b.den() < 0) ? -Ring(b.num()) : Ring(b.num());
+			Ring bd = (b.den() < 0) ? -Ring(b.den()) : Ring(b.den());
+			if (a.den() == b.den()) return {an - bn, ad};
+			return {an * bd - bn * ad, ad * bd};
+		}
+
+		/**
+		 * Writes the numerators of <tt>row</tt> over a common denominator into <tt>out</tt> and returns that
+		 * denominator. A row whose denominators are all equal is left as it is.
+		 */
+		template <typename Ring, int N>
+		Ring common_denominator(const Rational<Ring> (&row)[N], Ring (&out)[N]) {
+			bool same = true;
+			for (int j = 1; j < N; ++j) same = same && row[j].q == row[0].q;
+			if (same) {
+				for (int j = 0; j < N; ++j) out[j] = row[j].p;
+				return row[0].q;
+			}
+			Ring common = row[0].q;
+			for (int j = 1; j < N; ++j) common = common * row[j].q;
+			for (int j = 0; j < N; ++j) {
+				out[j] = row[j].p;
+				for (int k = 0; k < N; ++k) {
+					if (k != j) out[j] = out[j] * row[k].q;
+				}
+			}
+			return common;
+		}
+
+		template <typename Ring>
+		Ring det3(const Ring (&r0)[3], const Ring (&r1)[3], const Ring (&r2)[3]) {
+			return r0[0] * (r1[1] * r2[2] - r1[2] * r2[1])
+			     - r0[1] * (r1[0] * r2[2] - r1[2] * r2[0])
+			     + r0[2] * (r1[0] * r2[1] - r1[1] * r2[0]);
+		}
+
+		template <typename Ring>
+		bool orient2d_exact(const Point2 &a, const Point2 &b, const Point2 &c, int &sign) {
+			Rational<Ring> ac[2] = {difference<Ring>(a.x, c.x), difference<Ring>(a.y, c.y)};
+			Rational<Ring> bc[2] = {difference<Ring>(b.x, c.x), difference<Ring>(b.y, c.y)};
+			Ring acs[2], bcs[2];
+			common_denominator(ac, acs);
+			common_denominator(bc, bcs);
+			Ring det = acs[0] * bcs[1] - acs[1] * bcs[0];
+			if (overflowed(det)) return false;
+			sign = det.sign();
+			return true;
+		}
+
+		template <typename Ring>
+		bool orient3d_exact(const Point3 &a, const Point3 &b, const Point3 &c, const Point3 &d, int &sign) {
+			const Point3* rows[3] = {&a, &b, &c};
+			Ring m[3][3];
+			for (int i = 0; i < 3; ++i) {
+				Rational<Ring> row[3] = {
+					difference<Ring>(rows[i]->x, d.x),
+					difference<Ring>(rows[i]->y, d.y),
+					difference<Ring>(rows[i]->z, d.z)
+				};
+				common_denominator(row, m[i]);
+			}
+			Ring det = det3(m[0], m[1], m[2]);
+			if (overflowed(det)) return false;
+			sign = det.sign();
+			return true;
+		}
+
+		template <typename Ring>
+		bool incircle_exact(const Point2 &a, const Point2 &b, const Point2 &c, const Point2 &d, int &sign) {
+			const Point2* rows[3] = {&a, &b, &c};
+			Ring m[3][3];
+			for (int i = 0; i < 3; ++i) {
+				Rational<Ring> row[2] = {difference<Ring>(rows[i]->x, d.x), difference<Ring>(rows[i]->y, d.y)};
+				Ring scaled[2];
+				Ring common = common_denominator(row, scaled);
+				// (x/q, y/q, (x^2+y^2)/q^2) scaled by q^2
+				m[i][0] = scaled[0] * common;
+				m[i][1] = scaled[1] * common;
+				m[i][2] = scaled[0] * scaled[0] + scaled[1] * scaled[1];
+			}
+			Ring det = det3(m[0], m[1], m[2]);
+			if (overflowed(det)) return false;
+			sign = det.sign();
+			return true;
+		}
+
+		// error bound factors, generous multiples of the unit roundoff 2^-53 covering input and evaluation rounding
+		const double orient2d_bound = 1.7763568394002505e-15; // 2^-49
+		const double orient3d_bound = 1.4210854715202004e-14; // 2^-46
+		const double incircle_bound = 5.6843418860808015e-14; // 2^-44
+	}
+
+	/**
+	 * \brief Tells on which side of the line through <tt>a</tt> and <tt>b</tt> the point <tt>c</tt> lies.
+	 *
+	 * @return <tt>1</tt> if <tt>a</tt>, <tt>b</tt>, <tt>c</tt> are in counterclockwise order, <tt>-1</tt> if they
+	 *         are in clockwise order and <tt>0</tt> if they are collinear.
+	 */
+	int orient2d(const Point2 &a, const Point2 &b, const Point2 &c) {
+		double ax = a.x.to_double(), ay = a.y.to_double();
+		double bx = b.x.to_double(), by = b.y.to_double();
+		double cx = c.x.to_double(), cy = c.y.to_double();
+
+		double det = (ax - cx) * (by - cy) - (ay - cy) * (bx - cx);
+		double permanent = (std::fabs(ax) + std::fabs(cx)) * (std::fabs(by) + std::fabs(cy))
+		                 + (std::fabs(ay) + std::fabs(cy)) * (std::fabs(bx) + std::fabs(cx));
+		double bound = detail::orient2d_bound * permanent;
+		if (det >  bound) return 1;
+		if (det < -bound) return -1;
+
+		int sign = 0;
+#if defined(__SIZEOF_INT128__)
+		if (detail::orient2d_exact<detail::Checked128>(a, b, c, sign)) return sign;
+#endif
+		detail::orient2d_exact<BigInteger>(a, b, c, sign);
+		return sign;
+	}
+
+	/**
+	 * \brief Tells on which side of the plane through <tt>a</tt>, <tt>b</tt> and <tt>c</tt> the point <tt>d</tt> lies.
+	 *
+	 * @return <tt>1</tt> if <tt>d</tt> lies below the plane, i.e. <tt>a</tt>, <tt>b</tt>, <tt>c</tt> appear in
+	 *         counterclockwise order seen from above, <tt>-1</tt> if it lies above and <tt>0</tt> if the four points
+	 *         are coplanar.
+	 */
+	int orient3d(const Point3 &a, const Point3 &b, const Point3 &c, const Point3 &d) {
+		double dx = d.x.to_double(), dy = d.y.to_double(), dz = d.z.to_double();
+		const Point3* points[3] = {&a, &b, &c};
+		double m[3][3], s[3][3];
+		for (int i = 0; i < 3; ++i) {
+			double x = points[i]->x.to_double(), y = points[i]->y.to_double(), z = points[i]->z.to_double();
+			m[i][0] = x - dx;
+			m[i][1] = y - dy;
+			m[i][2] = z - dz;
+			s[i][0] = std::fabs(x) + std::fabs(dx);
+			s[i][1] = std::fabs(y) + std::fabs(dy);
+			s[i][2] = std::fabs(z) + std::fabs(dz);
+		}
+
+		double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+		           - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+		           + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+		double permanent = s[0][0] * (s[1][1] * s[2][2] + s[1][2] * s[2][1])
+		                 + s[0][1] * (s[1][0] * s[2][2] + s[1][2] * s[2][0])
+		                 + s[0][2] * (s[1][0] * s[2][1] + s[1][1] * s[2][0]);
+		double bound = detail::orient3d_bound * permanent;
+		if (det >  bound) return 1;
+		if (det < -bound) return -1;
+
+		int sign = 0;
+#if defined(__SIZEOF_INT128__)
+		if (detail::orient3d_exact<detail::Checked128>(a, b, c, d, sign)) return sign;
+#endif
+		detail::orient3d_exact<BigInteger>(a, b, c, d, sign);
+		return sign;
+	}
+
+	/**
+	 * \brief Tells if <tt>d</tt> lies inside the circle through <tt>a</tt>, <tt>b</tt> and <tt>c</tt>.
+	 *
+	 * @attention <tt>a</tt>, <tt>b</tt>, <tt>c</tt> must be in counterclockwise order, otherwise the sign flips.
+	 *
+	 * @return <tt>1</tt> if <tt>d</tt> lies inside the circle, <tt>-1</tt> if it lies outside and <tt>0</tt> if
+	 *         the four points are cocircular.
+	 */
+	int incircle(const Point2 &a, const Point2 &b, const Point2 &c, const Point2 &d) {
+		double dx = d.x.to_double(), dy = d.y.to_double();
+		const Point2* points[3] = {&a, &b, &c};
+		double m[3][3], s[3][3];
+		for (int i = 0; i < 3; ++i) {
+			double x = points[i]->x.to_double(), y = points[i]->y.to_double();
+			m[i][0] = x - dx;
+			m[i][1] = y - dy;
+			m[i][2] = m[i][0] * m[i][0] + m[i][1] * m[i][1];
+			s[i][0] = std::fabs(x) + std::fabs(dx);
+			s[i][1] = std::fabs(y) + std::fabs(dy);
+			s[i][2] = s[i][0] * s[i][0] + s[i][1] * s[i][1];
+		}
+
+		double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+		           - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+		           + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+		double permanent = s[0][0] * (s[1][1] * s[2][2] + s[1][2] * s[2][1])
+		                 + s[0][1] * (s[1][0] * s[2][2] + s[1][2] * s[2][0])
+		                 + s[0][2] * (s[1][0] * s[2][1] + s[1][1] * s[2][0]);
+		double bound = detail::incircle_bound * permanent;
+		if (det >  bound) return 1;
+		if (det < -bound) return -1;
+
+		int sign = 0;
+#if defined(__SIZEOF_INT128__)
+		if (detail::incircle_exact<detail::Checked128>(a, b, c, d, sign)) return sign;
+#endif
+		detail::incircle_exact<BigInteger>(a, b, c, d, sign);
+		return sign;
+	}
+
+	namespace detail {
+		/**
+		 * Tells if <tt>p</tt>, known to be collinear with <tt>a</tt> and <tt>b</tt>, lies on the segment between them.
+		 */
+		inline bool within_bounds(const Point2 &a, const Point2 &b, const Point2 &p) {
+			int ax = p.x.compare(a.x), bx = p.x.compare(b.x);
+			int ay = p.y.compare(a.y), by = p.y.compare(b.y);
+			return ax * bx <= 0 && ay * by <= 0;
+		}
+	}
+
+	/**
+	 * \brief Tells if the closed segments <tt>a1 a2</tt> and <tt>b1 b2</tt> have a point in common.
+	 *
+	 * Touching endpoints and overlapping collinear segments count as intersecting.
+	 *
+	 * @return <tt>true</tt> if the segments intersect.
+	 */
+	bool segments_intersect(const Point2 &a1, const Point2 &a2, const Point2 &b1, const Point2 &b2) {
+		int d1 = orient2d(b1, b2, a1);
+		int d2 = orient2d(b1, b2, a2);
+		int d3 = orient2d(a1, a2, b1);
+		int d4 = orient2d(a1, a2, b2);
+
+		if (d1 * d2 < 0 && d3 * d4 < 0) return true;
+
+		return (d1 == 0 && detail::within_bounds(b1, b2, a1))
+		    || (d2 == 0 && detail::within_bounds(b1, b2, a2))
+		    || (d3 == 0 && detail::within_bounds(a1, a2, b1))
+		    || (d4 == 0 && detail::within_bounds(a1, a2, b2));
+	}
+}
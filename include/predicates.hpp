@@ -0,0 +1,61 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file predicates.hpp
+ * Contains exact geometric predicates over Fraction coordinates.
+ */
+
+#ifndef NPASSON_PREDICATES_HPP
+#define NPASSON_PREDICATES_HPP
+
+#include "fraction.hpp"
+
+namespace npasson {
+
+	/**
+	 * A point in the plane with exact coordinates.
+	 */
+	struct Point2 {
+		Fraction x;
+		Fraction y;
+	};
+
+	/**
+	 * A point in space with exact coordinates.
+	 */
+	struct Point3 {
+		Fraction x;
+		Fraction y;
+		Fraction z;
+	};
+
+	int  orient2d(const Point2&, const Point2&, const Point2&);
+	int  orient3d(const Point3&, const Point3&, const Point3&, const Point3&);
+	int  incircle(const Point2&, const Point2&, const Point2&, const Point2&);
+	bool segments_intersect(const Point2&, const Point2&, const Point2&, const Point2&);
+}
+
+#ifdef NPASSON_EXPERIMENTAL_COMPILE
+#include "predicates.cpp"
+#endif
+
+#endif //NPASSON_PREDICATES_HPP
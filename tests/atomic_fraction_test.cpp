@@ -0,0 +1,100 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file atomic_fraction_test.cpp
+ * Tests of AtomicFraction and ShardedFractionAccumulator under concurrent updates and reads.
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "atomic_fraction.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	void test_sums() {
+		AtomicFraction atomic;
+		ShardedFractionAccumulator sharded(4);
+		std::vector<std::thread> pool;
+		for (int t = 0; t < 8; ++t) {
+			pool.push_back(std::thread([&]() {
+				for (int i = 0; i < 1000; ++i) {
+					atomic.fetch_add(Fraction(1, 6));
+					atomic.fetch_sub(Fraction(1, 12));
+					sharded.add(Fraction(1, 4));
+				}
+			}));
+		}
+		for (std::thread &thread : pool) thread.join();
+		NPASSON_CHECK(atomic.load() == Fraction(8000, 12));
+		NPASSON_CHECK(sharded.load() == Fraction(2000));
+		sharded.reset();
+		NPASSON_CHECK(sharded.load() == Fraction(0));
+	}
+
+	void test_torn_reads() {
+		// a load that mixed the parts of both values would give 1/7 or 5/3
+		AtomicFraction atomic(Fraction(1, 3));
+		std::atomic<bool> done(false);
+		std::atomic<int> torn(0);
+		std::vector<std::thread> readers;
+		for (int t = 0; t < 2; ++t) {
+			readers.push_back(std::thread([&]() {
+				while (!done.load()) {
+					Fraction value = atomic.load();
+					if (value != Fraction(1, 3) && value != Fraction(5, 7)) ++torn;
+				}
+			}));
+		}
+		for (int i = 0; i < 200000; ++i) {
+			atomic.store((i & 1) ? Fraction(1, 3) : Fraction(5, 7));
+		}
+		done = true;
+		for (std::thread &thread : readers) thread.join();
+		NPASSON_CHECK(torn.load() == 0);
+	}
+
+	void test_values() {
+		AtomicFraction atomic(Fraction(2, 4));
+		Fraction expected(3, 6);
+		NPASSON_CHECK(atomic.compare_exchange(expected, Fraction(1, 5)));
+		NPASSON_CHECK(atomic.load() == Fraction(1, 5));
+		expected = Fraction(1, 2);
+		NPASSON_CHECK(!atomic.compare_exchange(expected, Fraction(0)) && expected == Fraction(1, 5));
+		NPASSON_CHECK(atomic.exchange(Fraction(false)) == Fraction(1, 5));
+		NPASSON_CHECK(!atomic.load().valid());
+		atomic.store(Fraction(9223372036854775807ll));
+		atomic.fetch_add(Fraction(1));
+		NPASSON_CHECK(!atomic.load().valid());
+	}
+}
+
+int main() {
+	test_sums();
+	test_torn_reads();
+	test_values();
+	return test::result();
+}
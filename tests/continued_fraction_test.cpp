@@ -0,0 +1,90 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file continued_fraction_test.cpp
+ * Tests of ContinuedFraction decimal expansions and arithmetic.
+ */
+
+#include "continued_fraction.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	void test_decimal() {
+		NPASSON_CHECK(ContinuedFraction(Fraction(3)).decimal(5) == "3");
+		NPASSON_CHECK(ContinuedFraction(Fraction(0)).decimal(3) == "0");
+		NPASSON_CHECK(ContinuedFraction(Fraction(-2)).decimal(2) == "-2");
+		NPASSON_CHECK(ContinuedFraction(Fraction(1, 4)).decimal(0) == "0");
+		NPASSON_CHECK(ContinuedFraction(Fraction(-1, 4)).decimal(0) == "0");
+		NPASSON_CHECK(ContinuedFraction(Fraction(-1, 4)).decimal(1) == "-0.2");
+		NPASSON_CHECK(ContinuedFraction(Fraction(-1, 400)).decimal(2) == "0.00");
+		NPASSON_CHECK(ContinuedFraction(Fraction(-1, 400)).decimal(3) == "-0.002");
+		NPASSON_CHECK(ContinuedFraction(Fraction(-1, 4)).decimal(6) == "-0.25");
+		NPASSON_CHECK(ContinuedFraction(Fraction(22, 7)).decimal(4) == "3.1428");
+		NPASSON_CHECK(ContinuedFraction(Fraction(-7, 2)).decimal(3) == "-3.5");
+	}
+
+	void test_irrational() {
+		ContinuedFraction root2 = ContinuedFraction::sqrt(Fraction(2));
+		NPASSON_CHECK(root2.decimal(0) == "1");
+		NPASSON_CHECK(root2.decimal(10) == "1.4142135623");
+		NPASSON_CHECK((-root2).decimal(4) == "-1.4142");
+		NPASSON_CHECK((root2 + Fraction(1, 2)).decimal(5) == "1.91421");
+	}
+
+	void test_shared() {
+		ContinuedFraction root2 = ContinuedFraction::sqrt(Fraction(2));
+		// two copies of one quadratic irrational are combined exactly
+		NPASSON_CHECK((root2 * root2).decimal(3) == "2");
+		NPASSON_CHECK((root2 - root2).decimal(5) == "0");
+		NPASSON_CHECK((root2 / root2).decimal(5) == "1");
+		NPASSON_CHECK((root2 + root2).decimal(6) == "2.828427");
+		NPASSON_CHECK((root2 * root2).convergent(5) == Fraction(2));
+		ContinuedFraction golden = ContinuedFraction::quadratic(BigInteger(1), BigInteger(5), BigInteger(2));
+		ContinuedFraction square = golden * golden;
+		NPASSON_CHECK(square.decimal(4) == "2.6180"); // phi^2 = phi + 1
+		NPASSON_CHECK((square - square).decimal(2) == "0");
+		NPASSON_CHECK((ContinuedFraction(Fraction(3, 7)) / ContinuedFraction(Fraction(3, 7))).decimal(2) == "1");
+		ContinuedFraction zero(Fraction(0));
+		NPASSON_CHECK((zero / zero).decimal(2).empty());
+
+		// a computed value is fed term by term into both operands, so the difference collapses
+		ContinuedFraction shifted = root2 + Fraction(1, 2);
+		NPASSON_CHECK((shifted - shifted).decimal(5) == "0");
+		NPASSON_CHECK((shifted / shifted).decimal(5) == "1");
+		NPASSON_CHECK((shifted + shifted).decimal(5) == "3.82842");
+		NPASSON_CHECK((shifted * shifted).decimal(5) == "3.66421"); // 9/4 + sqrt(2)
+		// exactly 2, but no bound on the product of the computed copies settles whether the first digit is 1 or 2;
+		// the coefficient bound gives up after a few hundred terms
+		ContinuedFraction computed = root2 + Fraction(0);
+		NPASSON_CHECK((computed * computed).decimal(3).empty());
+	}
+}
+
+int main() {
+	test_decimal();
+	test_irrational();
+	test_shared();
+	return test::result();
+}
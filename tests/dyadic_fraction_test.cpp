@@ -0,0 +1,70 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file dyadic_fraction_test.cpp
+ * Tests of DyadicFraction arithmetic, in particular with zero operands far from the range of Fraction.
+ */
+
+#include <cmath>
+
+#include "dyadic_fraction.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	void test_zero() {
+		DyadicFraction tiny(1e-20), huge = DyadicFraction::from_parts(1, 100), zero(0ll);
+		NPASSON_CHECK((zero + tiny).is_dyadic() && (zero + tiny).to_double() == 1e-20);
+		NPASSON_CHECK((tiny + zero).is_dyadic() && (tiny + zero).to_double() == 1e-20);
+		NPASSON_CHECK((zero + huge).to_double() == std::ldexp(1.0, 100));
+		NPASSON_CHECK((huge - zero).to_double() == std::ldexp(1.0, 100));
+		NPASSON_CHECK((zero - tiny).to_double() == -1e-20);
+
+		DyadicFraction acc(0ll);
+		acc += tiny;
+		acc += tiny;
+		NPASSON_CHECK(acc.to_double() == 2e-20);
+		acc -= acc;
+		NPASSON_CHECK(acc.mantissa() == 0 && acc.exponent() == 0);
+		NPASSON_CHECK((zero + DyadicFraction(Fraction(1, 3))).to_fraction() == Fraction(1, 3));
+	}
+
+	void test_arithmetic() {
+		DyadicFraction a(0.75), b(-2.5);
+		NPASSON_CHECK((a + b).to_fraction() == Fraction(-7, 4));
+		NPASSON_CHECK((a * b).to_fraction() == Fraction(-15, 8));
+		NPASSON_CHECK((a / DyadicFraction(4ll)).to_fraction() == Fraction(3, 16));
+		NPASSON_CHECK(!(a / DyadicFraction(5ll)).is_dyadic());
+		NPASSON_CHECK((a / DyadicFraction(5ll)).to_fraction() == Fraction(3, 20));
+		NPASSON_CHECK((a / DyadicFraction(3ll)).is_dyadic());
+		NPASSON_CHECK(DyadicFraction(1e-20) < DyadicFraction(1e-19) && DyadicFraction(-1e-20) < DyadicFraction(0ll));
+		NPASSON_CHECK(DyadicFraction(Fraction(1, 3)) > DyadicFraction(0.3333));
+	}
+}
+
+int main() {
+	test_zero();
+	test_arithmetic();
+	return test::result();
+}
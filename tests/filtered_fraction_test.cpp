@@ -0,0 +1,67 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file filtered_fraction_test.cpp
+ * Tests of FilteredFraction ordering, including shadows that tie and invalid Fractions.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "filtered_fraction.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	void test_invalid_order() {
+		Fraction invalid(false);
+		NPASSON_CHECK(invalid.compare(Fraction(1)) > 0);
+		NPASSON_CHECK(Fraction(1).compare(invalid) < 0);
+		NPASSON_CHECK(invalid.compare(Fraction(0)) > 0);
+		NPASSON_CHECK(invalid.compare(Fraction(3, 0)) == 0);
+		NPASSON_CHECK(FilteredFraction(invalid) > FilteredFraction(Fraction(1ll << 62, 1)));
+		NPASSON_CHECK(FilteredFraction(invalid) == FilteredFraction(Fraction(3, 0)));
+	}
+
+	void test_sort() {
+		// the last two differ by far less than an ulp of their shadow, the zeros compare against invalid values
+		std::vector<Fraction> fracs = {
+			Fraction(false), Fraction(3, 4), Fraction(0), Fraction(-5, 2), Fraction(7, 0), Fraction(0),
+			Fraction(1, 3), Fraction((1ll << 60) + 1, 1ll << 60), Fraction(1ll << 60, (1ll << 60) - 1),
+		};
+		FilteredFraction::sort(fracs.data(), fracs.size());
+		for (std::size_t i = 0; i + 1 < fracs.size(); ++i) {
+			NPASSON_CHECK(fracs[i].compare(fracs[i + 1]) <= 0);
+		}
+		NPASSON_CHECK(fracs[0] == Fraction(-5, 2));
+		NPASSON_CHECK(fracs[5].num() == (1ll << 60) + 1 && fracs[6].num() == 1ll << 60);
+		NPASSON_CHECK(!fracs[7].valid() && !fracs[8].valid());
+	}
+}
+
+int main() {
+	test_invalid_order();
+	test_sort();
+	return test::result();
+}
@@ -0,0 +1,96 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file fixed_fraction_test.cpp
+ * Tests of FixedFraction rounding and of its overflow and invalid handling.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "fixed_fraction.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	typedef FixedFraction<100> Cents;
+	const long long signed int max = std::numeric_limits<long long signed int>::max();
+
+	void test_rounding() {
+		NPASSON_CHECK(Cents(Fraction(1, 3)).raw() == 33);
+		NPASSON_CHECK(Cents(Fraction(1, 3), RoundingMode::upward).raw() == 34);
+		NPASSON_CHECK(Cents(Fraction(-1, 3), RoundingMode::downward).raw() == -34);
+		NPASSON_CHECK(Cents(Fraction(1, 200)).raw() == 0);
+		NPASSON_CHECK(Cents(Fraction(3, 200)).raw() == 2);
+		NPASSON_CHECK(Cents(Fraction(-3, 200), RoundingMode::toward_zero).raw() == -1);
+		NPASSON_CHECK((Cents::from_units(150) * Cents::from_units(250)).raw() == 375);
+		NPASSON_CHECK((Cents::from_units(100) / Cents::from_units(300)).raw() == 33);
+		NPASSON_CHECK((Cents(7) - Cents(9)).to_fraction() == Fraction(-2));
+		NPASSON_CHECK(Cents::representable(Fraction(3, 4)) && !Cents::representable(Fraction(1, 3)));
+	}
+
+	void test_overflow() {
+		NPASSON_CHECK(!Cents(Fraction(1ll << 62, 1)).valid());
+		NPASSON_CHECK(!Cents(max / 50).valid());
+		NPASSON_CHECK(Cents(max / 100).raw() == max / 100 * 100);
+		NPASSON_CHECK(!(Cents::from_units(max) + Cents::from_units(1)).valid());
+		NPASSON_CHECK(!(Cents::from_units(-max) - Cents::from_units(1)).valid());
+		NPASSON_CHECK((Cents::from_units(-max) + Cents::from_units(max)).raw() == 0);
+		NPASSON_CHECK(!(Cents::from_units(max / 2) * Cents::from_units(300)).valid());
+		NPASSON_CHECK(!(Cents::from_units(max) / Cents::from_units(1)).valid());
+		NPASSON_CHECK(!(Cents::from_units(max / 2) * 3).valid());
+		NPASSON_CHECK(!Cents::representable(Fraction(1ll << 62, 4)));
+	}
+
+	void test_invalid() {
+		Cents invalid(Fraction(false));
+		NPASSON_CHECK(!invalid.valid());
+		NPASSON_CHECK(!Cents(Fraction(1, 0)).valid());
+		NPASSON_CHECK(!(Cents(1) / Cents(0)).valid());
+		NPASSON_CHECK(!(invalid + Cents(1)).valid());
+		NPASSON_CHECK(!(-invalid).valid());
+		NPASSON_CHECK(!(invalid * Cents(0)).valid());
+		NPASSON_CHECK(!invalid.to_fraction().valid());
+		NPASSON_CHECK(invalid > Cents::from_units(max) && Cents::from_units(-max) < Cents(0));
+
+		std::vector<Cents> values = {Cents(1), invalid, Cents(-1), Cents::from_units(max), Cents(0)};
+		Cents total = Cents::sum(values.data(), values.size());
+		NPASSON_CHECK(!total.valid());
+		std::sort(values.begin(), values.end());
+		NPASSON_CHECK(values.front() == Cents(-1) && !values.back().valid());
+
+		std::vector<Cents> acc = {Cents(1), Cents::from_units(max), invalid};
+		std::vector<Cents> delta = {Cents(2), Cents(1), Cents(1)};
+		Cents::add(acc.data(), delta.data(), acc.size());
+		NPASSON_CHECK(acc[0] == Cents(3) && !acc[1].valid() && !acc[2].valid());
+	}
+}
+
+int main() {
+	test_rounding();
+	test_overflow();
+	test_invalid();
+	return test::result();
+}
@@ -0,0 +1,82 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file fraction_expression_test.cpp
+ * Tests of lazily evaluated Fraction expressions, in particular their overflow handling.
+ */
+
+#include <limits>
+
+#include "fraction_expression.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	const long long signed int max = std::numeric_limits<long long signed int>::max();
+	const long long signed int min = std::numeric_limits<long long signed int>::min();
+
+	void test_checked() {
+		long long signed int r = 7;
+		NPASSON_CHECK(detail::checked_add(max - 1, 1, &r) && r == max);
+		NPASSON_CHECK(!detail::checked_add(max, 1, &r) && r == max);
+		NPASSON_CHECK(!detail::checked_add(-max, -1, &r));
+		NPASSON_CHECK(!detail::checked_sub(0, min, &r));
+		NPASSON_CHECK(detail::checked_sub(0, max, &r) && r == -max);
+		NPASSON_CHECK(!detail::checked_sub(-1, max, &r));
+		NPASSON_CHECK(detail::checked_mul(3037000499ll, 3037000499ll, &r) && r == 9223372030926249001ll);
+		NPASSON_CHECK(!detail::checked_mul(3037000500ll, 3037000500ll, &r));
+		NPASSON_CHECK(!detail::checked_mul(1ll << 32, -(1ll << 31), &r));
+		NPASSON_CHECK(detail::checked_mul(-max, 1, &r) && r == -max);
+	}
+
+	void test_values() {
+		Fraction a(1, 6), b(2, 9), c(-3, 4), d(5, 8);
+		NPASSON_CHECK((lazy(a) + b * lazy(c) - d).eval() == a + b * c - d);
+		NPASSON_CHECK((-(lazy(a) / c)).eval() == Fraction(2, 9));
+		NPASSON_CHECK(fmma(a, b, c, d) == Fraction(-373, 864));
+		// the plain products overflow, the reduced ones do not
+		Fraction big(max, 3);
+		NPASSON_CHECK((lazy(big) * Fraction(3, max)).eval() == Fraction(1));
+	}
+
+	void test_overflow() {
+		NPASSON_CHECK(!(lazy(Fraction(max)) + Fraction(1)).eval().valid());
+		NPASSON_CHECK(!(lazy(Fraction(max)) * Fraction(2)).eval().valid());
+		NPASSON_CHECK(!(lazy(Fraction(1, max)) * Fraction(1, 2)).eval().valid());
+		NPASSON_CHECK(!(lazy(Fraction(-max)) - Fraction(1)).eval().valid());
+		// the most negative value cannot be negated, so it is rejected instead
+		NPASSON_CHECK(!(-lazy(Fraction(min))).eval().valid());
+		NPASSON_CHECK(!(lazy(Fraction(min)) + Fraction(1)).eval().valid());
+		NPASSON_CHECK((-lazy(Fraction(-max))).eval() == Fraction(max));
+		NPASSON_CHECK(!(lazy(Fraction(false)) + Fraction(1)).eval().valid());
+		NPASSON_CHECK(!(lazy(Fraction(1)) / Fraction(0)).eval().valid());
+	}
+}
+
+int main() {
+	test_checked();
+	test_values();
+	test_overflow();
+	return test::result();
+}
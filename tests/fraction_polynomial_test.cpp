@@ -0,0 +1,94 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file fraction_polynomial_test.cpp
+ * Tests of FractionPolynomial products and evaluation against plain Fraction arithmetic.
+ */
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "fraction_polynomial.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	FractionPolynomial random_polynomial(std::mt19937_64 &random, std::size_t size) {
+		std::vector<Fraction> c;
+		for (std::size_t i = 0; i < size; ++i) {
+			c.push_back(Fraction(static_cast<long long signed int>(random() % 2001) - 1000,
+			                     1 + static_cast<long long signed int>(random() % 6)));
+		}
+		return FractionPolynomial(c);
+	}
+
+	// the schoolbook product on Fractions, which the scaled Karatsuba product has to match
+	FractionPolynomial naive_product(const FractionPolynomial &a, const FractionPolynomial &b) {
+		std::vector<Fraction> c(a.coefficient_list().size() + b.coefficient_list().size() - 1, Fraction(0));
+		for (std::size_t i = 0; i < a.coefficient_list().size(); ++i) {
+			for (std::size_t j = 0; j < b.coefficient_list().size(); ++j) {
+				c[i + j] = c[i + j] + a[i] * b[j];
+			}
+		}
+		return FractionPolynomial(c);
+	}
+
+	void test_products() {
+		std::mt19937_64 random(36);
+		const std::size_t sizes[] = {1, 5, 33, 80};
+		for (std::size_t na : sizes) {
+			for (std::size_t nb : sizes) {
+				FractionPolynomial a = random_polynomial(random, na), b = random_polynomial(random, nb);
+				NPASSON_CHECK(a * b == naive_product(a, b));
+			}
+		}
+		FractionPolynomial x_minus_one = {Fraction(-1), Fraction(1)};
+		FractionPolynomial quotient, remainder;
+		(x_minus_one * x_minus_one + FractionPolynomial(Fraction(3))).divmod(x_minus_one, quotient, remainder);
+		NPASSON_CHECK(quotient == x_minus_one && remainder == FractionPolynomial(Fraction(3)));
+	}
+
+	void test_evaluate() {
+		FractionPolynomial p = {Fraction(1, 2), Fraction(-3, 4), Fraction(2, 3)};
+		NPASSON_CHECK(p(Fraction(3, 5)) == Fraction(1, 2) - Fraction(9, 20) + Fraction(6, 25));
+		NPASSON_CHECK(!p(Fraction(false)).valid());
+		FractionPolynomial high = FractionPolynomial::monomial(Fraction(1), 12);
+		NPASSON_CHECK(high(Fraction(1, 30)) == Fraction(1, 531441000000000000ll));
+		NPASSON_CHECK(!high(Fraction(1, 1ll << 40)).valid());
+	}
+
+	void test_monomial() {
+		FractionPolynomial m = FractionPolynomial::monomial(Fraction(2, 3), 4);
+		NPASSON_CHECK(m.degree() == 4 && m[4] == Fraction(2, 3) && m[0] == Fraction(0));
+		NPASSON_CHECK(!FractionPolynomial::monomial(Fraction(1), SIZE_MAX).valid());
+	}
+}
+
+int main() {
+	test_products();
+	test_evaluate();
+	test_monomial();
+	return test::result();
+}
@@ -0,0 +1,243 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file fraction_test.cpp
+ * Tests of the Fraction conversions and floating point comparisons: every rounding mode and every comparison is
+ * checked against exact BigInteger arithmetic.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "big_integer.hpp"
+#include "fraction.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	// constructed during static initialization, possibly before the gcd table is filled
+	const Fraction early(-84, 126);
+
+	BigInteger power_of_two(int exp) {
+		BigInteger result(1);
+		for (; exp >= 30; exp -= 30) result *= BigInteger(1ll << 30);
+		return result * BigInteger(1ll << exp);
+	}
+
+	/**
+	 * Compares <tt>p/q</tt> (with <tt>q > 0</tt>) exactly against <tt>m * 2^e</tt>.
+	 */
+	int compare(const BigInteger &p, const BigInteger &q, const BigInteger &m, int e) {
+		return (e >= 0) ? p.compare(m * q * power_of_two(e)) : (p * power_of_two(-e)).compare(m * q);
+	}
+
+	/**
+	 * Splits a finite floating point value into an integer significand and an exponent.
+	 */
+	template <typename T>
+	void split(T value, BigInteger &m, int &e) {
+		int exp;
+		T mantissa = std::frexp(value, &exp);
+		m = BigInteger(static_cast<long long signed int>(std::ldexp(mantissa, std::numeric_limits<T>::digits)));
+		e = exp - std::numeric_limits<T>::digits;
+	}
+
+	template <typename T>
+	int compare(const Fraction &x, T value) {
+		BigInteger m;
+		int e;
+		split(value, m, e);
+		return compare(BigInteger(x.num()), BigInteger(x.den()), m, e);
+	}
+
+	/**
+	 * Checks that <tt>value</tt> is <tt>x</tt> correctly rounded in <tt>mode</tt>.
+	 */
+	template <typename T>
+	bool correctly_rounded(const Fraction &x, T value, RoundingMode mode) {
+		const T infinity = std::numeric_limits<T>::infinity();
+		T below = std::nextafter(value, -infinity), above = std::nextafter(value, infinity);
+		if (mode == RoundingMode::toward_zero) mode = (x.num() < 0) ? RoundingMode::upward : RoundingMode::downward;
+		switch (mode) {
+			case RoundingMode::downward: return compare(x, value) >= 0 && compare(x, above) < 0;
+			case RoundingMode::upward:   return compare(x, value) <= 0 && compare(x, below) > 0;
+			default: break;
+		}
+		// to nearest: value is one of the neighbours around x, the closer one, the even one on a tie
+		T low = (compare(x, value) >= 0) ? value : below;
+		T high = std::nextafter(low, infinity);
+		if (compare(x, low) < 0 || compare(x, high) > 0) return false;
+		BigInteger low_m, high_m;
+		int low_e, high_e;
+		split(low, low_m, low_e);
+		split(high, high_m, high_e);
+		int e = std::min(low_e, high_e);
+		BigInteger sum = low_m * power_of_two(low_e - e) + high_m * power_of_two(high_e - e);
+		int side = compare(BigInteger(x.num()) * BigInteger(2), BigInteger(x.den()), sum, e);
+		if (side < 0) return value == low;
+		if (side > 0) return value == high;
+		BigInteger value_m;
+		int value_e;
+		split(value, value_m, value_e);
+		return (value == low || value == high) && (value_m % BigInteger(2)).is_zero();
+	}
+
+	void test_rounding(const Fraction &x) {
+		const RoundingMode modes[] = {RoundingMode::to_nearest, RoundingMode::toward_zero,
+		                              RoundingMode::upward, RoundingMode::downward};
+		for (RoundingMode mode : modes) {
+			NPASSON_CHECK(correctly_rounded(x, x.to_double(mode), mode));
+			NPASSON_CHECK(correctly_rounded(x, x.to_float(mode), mode));
+		}
+	}
+
+	void test_conversions() {
+		const long long signed int max = 9223372036854775807ll;
+		test_rounding(Fraction(1, 3));
+		test_rounding(Fraction(-2, 3));
+		test_rounding(Fraction(max, 1));
+		test_rounding(Fraction(-max, 1));
+		test_rounding(Fraction(1, max));
+		test_rounding(Fraction(9007199254740993ll, 1)); // 2^53 + 1, a tie for double
+		test_rounding(Fraction(16777217, 1));           // 2^24 + 1, a tie for float
+		test_rounding(Fraction(max, max - 1));
+
+		std::mt19937_64 random(26);
+		for (int i = 0; i < 2000; ++i) {
+			int bits = 1 + static_cast<int>(random() % 63);
+			long long signed int num = static_cast<long long signed int>(random() >> (64 - bits));
+			long long signed int den = static_cast<long long signed int>(random() >> (1 + random() % 63)) + 1;
+			test_rounding(Fraction((random() & 1) ? -num : num, den));
+		}
+
+		NPASSON_CHECK(std::isnan(Fraction(false).to_double()));
+		NPASSON_CHECK(static_cast<long long int>(Fraction(-7, 2)) == -3);
+
+		// invalid Fractions convert to 0 instead of dividing by their zero denominator
+		NPASSON_CHECK(static_cast<long long int>(Fraction(false)) == 0);
+		NPASSON_CHECK(static_cast<long int>(Fraction(false)) == 0);
+		NPASSON_CHECK(static_cast<int>(Fraction(false)) == 0);
+		NPASSON_CHECK(static_cast<short>(Fraction(false)) == 0);
+		NPASSON_CHECK(static_cast<int>(Fraction(1, 0)) == 0);
+	}
+
+	/**
+	 * The result of <tt>compare(double)</tt>, from exact BigInteger arithmetic.
+	 */
+	int expected_compare(const Fraction &x, double value) {
+		if (!x.valid() || value != value) return 2;
+		if (value == std::numeric_limits<double>::infinity()) return -1;
+		if (value == -std::numeric_limits<double>::infinity()) return 1;
+		return compare(x, value);
+	}
+
+	void test_compare_double() {
+		const double infinity = std::numeric_limits<double>::infinity();
+		const double nan = std::numeric_limits<double>::quiet_NaN();
+
+		// near ties: 0.2 lies just above 1/5, 1.0/3 just below 1/3
+		NPASSON_CHECK(Fraction(1, 5).compare(0.2) == -1);
+		NPASSON_CHECK(Fraction(1, 3).compare(1.0 / 3) == 1);
+		NPASSON_CHECK(Fraction(1, 3) > 1.0 / 3 && 1.0 / 3 < Fraction(1, 3));
+		NPASSON_CHECK(!(Fraction(1, 3) <= 1.0 / 3) && !(1.0 / 3 >= Fraction(1, 3)));
+		NPASSON_CHECK(Fraction(1, 3) < 1.0f / 3 && 1.0f / 3 > Fraction(1, 3)); // the float lies above
+		NPASSON_CHECK(Fraction(-1, 3).compare(-1.0 / 3) == -1);
+
+		// exact matches
+		NPASSON_CHECK(Fraction(1, 4).compare(0.25) == 0);
+		NPASSON_CHECK(Fraction(1, 4) == 0.25 && 0.25 == Fraction(1, 4) && Fraction(1, 4) <= 0.25f);
+		NPASSON_CHECK(Fraction(9007199254740993ll, 1).compare(9007199254740992.0) == 1); // 2^53 + 1 vs 2^53
+
+		// Fraction(0.2) goes through six decimal digits and is 1/5 exactly, which the double 0.2 is not
+		NPASSON_CHECK(Fraction(0.2) == Fraction(1, 5));
+		NPASSON_CHECK(Fraction(0.2) != 0.2 && !(Fraction(0.2) == 0.2) && Fraction(0.2) < 0.2);
+
+		// signed zero, infinities, NaN and invalid Fractions
+		NPASSON_CHECK(Fraction(0).compare(-0.0) == 0 && Fraction(0) == -0.0);
+		NPASSON_CHECK(Fraction(1, 2).compare(-0.0) == 1 && Fraction(-1, 2).compare(-0.0) == -1);
+		NPASSON_CHECK(Fraction(9223372036854775807ll, 1).compare(infinity) == -1);
+		NPASSON_CHECK(Fraction(-9223372036854775807ll, 1).compare(-infinity) == 1);
+		NPASSON_CHECK(Fraction(1, 2).compare(nan) == 2 && Fraction(false).compare(1.0) == 2 && Fraction(false).compare(nan) == 2);
+		NPASSON_CHECK(!(Fraction(1, 2) == nan) && Fraction(1, 2) != nan && !(Fraction(1, 2) < nan) && !(Fraction(1, 2) >= nan));
+		NPASSON_CHECK(!(Fraction(false) == 0.0) && !(Fraction(false) < 1.0) && !(Fraction(false) > -1.0));
+
+		// the batch form against the scalar one and exact arithmetic, around values close to the Fractions
+		std::mt19937_64 random(27);
+		for (int trial = 0; trial < 200; ++trial) {
+			int bits = 1 + static_cast<int>(random() % 62);
+			long long signed int num = static_cast<long long signed int>(random() >> (64 - bits));
+			long long signed int den = static_cast<long long signed int>(random() >> (1 + random() % 63)) + 1;
+			Fraction centre((random() & 1) ? -num : num, den);
+			double rhs = centre.to_double();
+			if (trial % 4 == 1) rhs = std::nextafter(rhs, infinity);
+			if (trial % 4 == 2) rhs = std::nextafter(rhs, -infinity);
+			if (trial % 50 == 3) rhs = infinity;
+			if (trial % 50 == 4) rhs = nan;
+
+			std::vector<Fraction> in;
+			for (int i = 0; i < 37; ++i) {
+				switch (random() % 4) {
+					case 0: in.push_back(centre); break;
+					case 1: in.push_back(Fraction(centre.num() + static_cast<long long signed int>(random() % 3) - 1, centre.den())); break;
+					case 2: in.push_back(Fraction(static_cast<long long signed int>(random() >> 2) - (1ll << 61),
+					                              static_cast<long long signed int>(random() >> (1 + random() % 63)) + 1)); break;
+					default: in.push_back(Fraction(false)); break;
+				}
+			}
+			std::vector<signed char> out(in.size());
+			Fraction::compare(in.data(), in.size(), rhs, out.data());
+			for (std::size_t i = 0; i < in.size(); ++i) {
+				NPASSON_CHECK(out[i] == in[i].compare(rhs));
+				NPASSON_CHECK(out[i] == expected_compare(in[i], rhs));
+			}
+		}
+	}
+
+	void test_reduction() {
+		NPASSON_CHECK(early.num() == -2 && early.den() == 3);
+		// every pair below the default table size, against Euclid's algorithm
+		for (long long signed int a = 1; a < 300; ++a) {
+			for (long long signed int b = 1; b < 300; ++b) {
+				Fraction frac(a, b);
+				long long signed int divisor = a, rest = b;
+				while (rest != 0) {
+					long long signed int t = divisor % rest;
+					divisor = rest;
+					rest = t;
+				}
+				NPASSON_CHECK(frac.num() == a / divisor && frac.den() == b / divisor);
+			}
+		}
+	}
+}
+
+int main() {
+	test_conversions();
+	test_compare_double();
+	test_reduction();
+	return test::result();
+}
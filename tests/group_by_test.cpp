@@ -0,0 +1,122 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file group_by_test.cpp
+ * Tests of FractionMap keys and of FractionGroupBy on one and several threads.
+ */
+
+#include <random>
+#include <vector>
+
+#include "group_by.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	void test_map_keys() {
+		FractionMap<int> map;
+		map[Fraction(0)] = 1;
+		map[Fraction(false)] = 2;
+		NPASSON_CHECK(map.size() == 2);
+		NPASSON_CHECK(*map.find(Fraction(0)) == 1);
+		// every invalid Fraction is the same key, distinct from 0 although Fraction(5, 0) stores 0/1
+		NPASSON_CHECK(*map.find(Fraction(5, 0)) == 2);
+
+		Fraction half(-1, 2), inverted(-2);
+		Fraction::invert(inverted);
+		NPASSON_CHECK(inverted.num() == 1 && inverted.den() == -2);
+		map[half] = 3;
+		NPASSON_CHECK(*map.find(inverted) == 3);
+
+		// 1/-2^63 has no positive denominator and joins the invalid key
+		Fraction extreme(-9223372036854775807ll - 1);
+		Fraction::invert(extreme);
+		NPASSON_CHECK(*map.find(extreme) == 2);
+
+		int invalid_keys = 0;
+		map.for_each([&](const Fraction &key, int value) {
+			if (!key.valid()) invalid_keys += value;
+		});
+		NPASSON_CHECK(invalid_keys == 2);
+		NPASSON_CHECK(map.erase(Fraction(false)) && !map.find(Fraction(1, 0)) && *map.find(Fraction(0)) == 1);
+	}
+
+	void test_threads() {
+		std::mt19937_64 random(35);
+		std::vector<Fraction> keys, values;
+		for (int i = 0; i < 20000; ++i) {
+			long long signed int k = static_cast<long long signed int>(random() % 500) - 250;
+			keys.push_back((k == 0 && (random() & 1)) ? Fraction(false) : Fraction(k, 1 + static_cast<long long signed int>(random() % 7)));
+			values.push_back(Fraction(static_cast<long long signed int>(random() % 1000) - 500, 1 + static_cast<long long signed int>(random() % 12)));
+		}
+
+		FractionGroupBy single;
+		single.add(keys.data(), values.data(), keys.size());
+		const unsigned int threads[] = {2, 3, 8, 40};
+		for (unsigned int t : threads) {
+			FractionGroupBy parallel(16);
+			parallel.add(keys.data(), values.data(), keys.size(), t);
+			NPASSON_CHECK(parallel.size() == single.size());
+			single.for_each([&](const Fraction &key, const FractionAggregate &expected) {
+				const FractionAggregate *actual = parallel.find(key);
+				NPASSON_CHECK(actual && actual->count == expected.count && actual->sum == expected.sum
+				              && actual->min == expected.min && actual->max == expected.max);
+			});
+		}
+
+		const FractionAggregate *invalid = single.find(Fraction(false));
+		const FractionAggregate *zero = single.find(Fraction(0));
+		NPASSON_CHECK(invalid && zero && invalid->count > 0 && zero->count > 0);
+	}
+
+	void test_chunks() {
+		// more rows than one chunk, and a last chunk that is not full
+		const std::size_t count = FractionGroupBy::chunk_rows * 5 / 2 + 7;
+		std::vector<Fraction> keys, values;
+		for (std::size_t i = 0; i < count; ++i) {
+			keys.push_back(Fraction(static_cast<long long signed int>(i % 97)));
+			values.push_back(Fraction(static_cast<long long signed int>(i), 1 + static_cast<long long signed int>(i % 4)));
+		}
+		FractionGroupBy single;
+		single.add(keys.data(), values.data(), count);
+		FractionGroupBy parallel(8);
+		parallel.add(keys.data(), values.data(), count, 4);
+		NPASSON_CHECK(parallel.size() == 97);
+		unsigned long long int rows = 0;
+		single.for_each([&](const Fraction &key, const FractionAggregate &expected) {
+			const FractionAggregate *actual = parallel.find(key);
+			NPASSON_CHECK(actual && actual->count == expected.count && actual->sum == expected.sum
+			              && actual->min == expected.min && actual->max == expected.max);
+			rows += expected.count;
+		});
+		NPASSON_CHECK(rows == count);
+	}
+}
+
+int main() {
+	test_map_keys();
+	test_threads();
+	test_chunks();
+	return test::result();
+}
@@ -0,0 +1,183 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file instrumentation_test.cpp
+ * Tests of the instrumentation counters, with the library compiled into the test and NPASSON_INSTRUMENT defined.
+ */
+
+#include <cctype>
+#include <string>
+#include <thread>
+
+#include "fraction.hpp"
+#include "instrumentation.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	/**
+	 * A strict JSON recognizer, enough for the output of <tt>json()</tt>.
+	 */
+	class JsonReader {
+
+	private:
+		const std::string &text;
+		std::size_t at = 0;
+
+		void space() {
+			while (at < text.size() && std::isspace(static_cast<unsigned char>(text[at]))) ++at;
+		}
+
+		bool literal(char c) {
+			space();
+			if (at >= text.size() || text[at] != c) return false;
+			++at;
+			return true;
+		}
+
+		bool string() {
+			if (!literal('"')) return false;
+			while (at < text.size() && text[at] != '"') {
+				if (text[at] == '\\') ++at;
+				++at;
+			}
+			return at++ < text.size();
+		}
+
+		bool number() {
+			space();
+			std::size_t start = at;
+			if (at < text.size() && text[at] == '-') ++at;
+			while (at < text.size() && (std::isdigit(static_cast<unsigned char>(text[at])) || text[at] == '.')) ++at;
+			return at > start;
+		}
+
+		template <typename F>
+		bool list(char close, F element) {
+			if (literal(close)) return true;
+			do {
+				if (!element()) return false;
+			} while (literal(','));
+			return literal(close);
+		}
+
+	public:
+		explicit JsonReader(const std::string &text) : text(text) {}
+
+		bool value() {
+			space();
+			if (at >= text.size()) return false;
+			if (literal('{')) return list('}', [this]() {return string() && literal(':') && value();});
+			if (literal('[')) return list(']', [this]() {return value();});
+			if (text[at] == '"') return string();
+			return number();
+		}
+
+		bool document() {
+			if (!value()) return false;
+			space();
+			return at == text.size();
+		}
+	};
+
+	unsigned long long int constructions(const FractionCounters &counters, ConstructionSource source) {
+		return counters.constructions[static_cast<int>(source)];
+	}
+
+	void test_counts() {
+		reset_fraction_counters();
+		Fraction reduced(6, 4);
+		NPASSON_CHECK(reduced == Fraction(3, 2));
+		FractionCounters counters = fraction_counters();
+		NPASSON_CHECK(counters.normalizations >= 1);
+		NPASSON_CHECK(constructions(counters, ConstructionSource::num_den) >= 1);
+
+		// 1000003 * 6 and 1000003 * 4 are past the gcd table, so Euclid runs
+		reset_fraction_counters();
+		NPASSON_CHECK(Fraction(6000018, 4000012) == Fraction(3, 2));
+		counters = fraction_counters();
+		NPASSON_CHECK(counters.gcd_calls >= 1 && counters.gcd_iterations >= counters.gcd_calls);
+
+		reset_fraction_counters();
+		Fraction half(0.5);
+		NPASSON_CHECK(half == Fraction(1, 2));
+		counters = fraction_counters();
+		NPASSON_CHECK(counters.string_conversions == 1);
+		NPASSON_CHECK(constructions(counters, ConstructionSource::double_float) == 1);
+		NPASSON_CHECK(constructions(counters, ConstructionSource::std_string) == 1);
+
+		reset_fraction_counters();
+		Fraction big(1ll << 40, 3);
+		Fraction product = big * Fraction(1ll << 40, 5);
+		static_cast<void>(product);
+		counters = fraction_counters();
+		NPASSON_CHECK(counters.overflows >= 1);
+		NPASSON_CHECK(counters.latency[static_cast<int>(FractionOperation::mul)].calls == 1);
+		NPASSON_CHECK(counters.latency[static_cast<int>(FractionOperation::mul)].samples == 1);
+
+		reset_fraction_counters();
+		Fraction invalid(false);
+		static_cast<void>(invalid + Fraction(1));
+		counters = fraction_counters();
+		// 0/0 + 1/1 builds 0/0 once more for the result
+		NPASSON_CHECK(counters.invalid_created == 2 && counters.invalid_operands == 1);
+	}
+
+	void test_threads() {
+		reset_fraction_counters();
+		std::thread worker([]() {
+			for (int i = 0; i < 100; ++i) static_cast<void>(Fraction(6, 4));
+		});
+		worker.join();
+		NPASSON_CHECK(fraction_counters().normalizations == 0);
+		FractionCounters all = all_fraction_counters();
+		NPASSON_CHECK(all.normalizations == 100);
+		NPASSON_CHECK(constructions(all, ConstructionSource::num_den) == 100);
+
+		// the calling thread's counts are included as well
+		static_cast<void>(Fraction(6, 4));
+		NPASSON_CHECK(all_fraction_counters().normalizations == 101);
+
+		reset_fraction_counters();
+		all = all_fraction_counters();
+		NPASSON_CHECK(all.normalizations == 0 && constructions(all, ConstructionSource::num_den) == 0);
+	}
+
+	void test_json() {
+		reset_fraction_counters();
+		static_cast<void>(Fraction(6, 4) + Fraction(0.25));
+		std::string json = all_fraction_counters().json();
+		NPASSON_CHECK(JsonReader(json).document());
+		NPASSON_CHECK(json.find("\"normalizations\": ") != std::string::npos);
+		NPASSON_CHECK(JsonReader(FractionCounters().json()).document());
+		NPASSON_CHECK(!all_fraction_counters().text().empty());
+	}
+}
+
+int main() {
+	test_counts();
+	test_threads();
+	test_json();
+	return test::result();
+}
@@ -0,0 +1,139 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file lattice_test.cpp
+ * Tests of LLL reduction: a planted low density knapsack is solved, and the reduced bases are checked exactly.
+ */
+
+#include <random>
+
+#include "lattice.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	/**
+	 * Rows (e_i | N a_i) and (0 | N s), where s is the sum of a planted subset of the a_i.
+	 */
+	Lattice knapsack(std::size_t n, std::vector<long long signed int> &a, long long signed int &s) {
+		std::mt19937_64 random(39);
+		const long long signed int weight = 1ll << 20;
+		std::vector<std::vector<BigInteger>> rows(n + 1, std::vector<BigInteger>(n + 1, BigInteger(0)));
+		a.clear();
+		s = 0;
+		for (std::size_t i = 0; i < n; ++i) {
+			a.push_back(static_cast<long long signed int>(random() >> 24)); // 40 bits, density 1/4 for n = 10
+			if (i % 3 != 1) s += a[i];
+			rows[i][i] = BigInteger(1);
+			rows[i][n] = BigInteger(a[i]) * BigInteger(weight);
+		}
+		rows[n][n] = BigInteger(s) * BigInteger(weight);
+		return Lattice(rows);
+	}
+
+	/**
+	 * @return If some row is a 0/1 vector, up to sign, selecting a subset of <tt>a</tt> that sums to <tt>s</tt>.
+	 */
+	bool solved(const Lattice &lattice, const std::vector<long long signed int> &a, long long signed int s) {
+		const std::size_t n = a.size();
+		for (const std::vector<BigInteger> &row : lattice.basis()) {
+			if (!row[n].is_zero()) continue;
+			int sign = 0;
+			long long signed int sum = 0;
+			bool binary = true;
+			for (std::size_t i = 0; i < n && binary; ++i) {
+				if (row[i].is_zero()) continue;
+				if (!sign) sign = row[i].sign();
+				binary = (row[i] == BigInteger(sign));
+				sum += a[i];
+			}
+			if (binary && sign && sum == s) return true;
+		}
+		return false;
+	}
+
+	BigInteger gram_determinant(const Lattice &lattice) {
+		std::vector<BigInteger> d;
+		std::vector<std::vector<BigInteger>> lambda;
+		lattice.gram_schmidt(d, lambda);
+		return d.back();
+	}
+
+	void test_knapsack() {
+		std::vector<long long signed int> a;
+		long long signed int s;
+		Lattice original = knapsack(10, a, s);
+		Lattice exact = original, guided = original;
+		NPASSON_CHECK(exact.lll(Fraction(99, 100)));
+		NPASSON_CHECK(guided.lll_guided(Fraction(99, 100)));
+		NPASSON_CHECK(exact.is_reduced(Fraction(99, 100)));
+		NPASSON_CHECK(guided.is_reduced(Fraction(99, 100)));
+		NPASSON_CHECK(gram_determinant(exact) == gram_determinant(original));
+		NPASSON_CHECK(gram_determinant(guided) == gram_determinant(original));
+		NPASSON_CHECK(solved(exact, a, s));
+		NPASSON_CHECK(solved(guided, a, s));
+	}
+
+	void test_small() {
+		Lattice lattice({{1, 1, 1}, {-1, 0, 2}, {3, 5, 6}});
+		NPASSON_CHECK(lattice.lll());
+		NPASSON_CHECK(lattice.is_reduced());
+		NPASSON_CHECK(gram_determinant(lattice) == BigInteger(9)); // |det|^2 of the original rows
+		Lattice dependent({{1, 2}, {2, 4}});
+		NPASSON_CHECK(!dependent.lll());
+		NPASSON_CHECK(!Lattice({{1, 0}, {0, 1}}).lll(Fraction(1, 4)));
+	}
+
+	void test_rational() {
+		Fraction negative(-6, 5);
+		Fraction::invert(negative); // 5/-6, stored over a negative denominator
+		const std::vector<std::vector<Fraction>> rows = {
+			{Fraction(1, 2), Fraction(1, 3)},
+			{Fraction(1, 4), negative}
+		};
+		Lattice lattice(rows);
+		NPASSON_CHECK(lattice.scale() == BigInteger(12));
+		NPASSON_CHECK(lattice.basis()[0][0] == BigInteger(6) && lattice.basis()[0][1] == BigInteger(4));
+		NPASSON_CHECK(lattice.basis()[1][0] == BigInteger(3) && lattice.basis()[1][1] == BigInteger(-10));
+		NPASSON_CHECK(lattice.lll());
+		NPASSON_CHECK(lattice.is_reduced());
+		NPASSON_CHECK(gram_determinant(lattice) == BigInteger(72 * 72)); // det = -1/2, times 12^2
+		// denominators whose lcm exceeds long long
+		const std::vector<std::vector<Fraction>> wide = {
+			{Fraction(1, 1000000007), Fraction(0)},
+			{Fraction(0), Fraction(1, 998244353)},
+			{Fraction(1, 1000000009), Fraction(1, 999999937)}
+		};
+		Lattice big(wide);
+		NPASSON_CHECK(big.scale() == BigInteger(1000000007ll * 998244353ll) * BigInteger(1000000009ll * 999999937ll));
+		NPASSON_CHECK(Lattice(std::vector<std::vector<Fraction>>{{Fraction(1), INVALID_FRACTION}}).size() == 0);
+	}
+}
+
+int main() {
+	test_knapsack();
+	test_small();
+	test_rational();
+	return test::result();
+}
@@ -0,0 +1,88 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file predicates_test.cpp
+ * Tests of the geometric predicates on degenerate and nearly degenerate inputs, where the floating point
+ * filter cannot decide and the exact stages must.
+ */
+
+#include "predicates.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	void test_orient() {
+		// collinear points with coordinates no double represents exactly
+		Point2 a = {Fraction(1, 3), Fraction(2, 7)};
+		Point2 b = {Fraction(1000001, 3), Fraction(2000009, 7)};
+		Point2 c = {a.x + (b.x - a.x) * Fraction(5, 11), a.y + (b.y - a.y) * Fraction(5, 11)};
+		NPASSON_CHECK(orient2d(a, b, c) == 0);
+		Point2 left = {c.x, c.y + Fraction(1, 1ll << 36)}; // below the filter's error bound
+		Point2 right = {c.x, c.y - Fraction(1, 1ll << 36)};
+		NPASSON_CHECK(orient2d(a, b, left) == 1);
+		NPASSON_CHECK(orient2d(a, b, right) == -1);
+		NPASSON_CHECK(orient2d(b, a, left) == -1);
+
+		Point3 p = {Fraction(1, 3), Fraction(0), Fraction(0)};
+		Point3 q = {Fraction(0), Fraction(1, 3), Fraction(0)};
+		Point3 r = {Fraction(0), Fraction(0), Fraction(1, 3)};
+		Point3 s = {Fraction(1, 9), Fraction(1, 9), Fraction(1, 9)}; // in the plane x + y + z = 1/3
+		NPASSON_CHECK(orient3d(p, q, r, s) == 0);
+		Point3 above = {s.x, s.y, s.z + Fraction(1, 1ll << 50)};
+		Point3 below = {s.x, s.y, s.z - Fraction(1, 1ll << 50)};
+		NPASSON_CHECK(orient3d(p, q, r, above) == -orient3d(p, q, r, below));
+		NPASSON_CHECK(orient3d(p, q, r, above) != 0);
+	}
+
+	void test_incircle() {
+		// points on the unit circle from Pythagorean triples, counterclockwise
+		Point2 a = {Fraction(3, 5), Fraction(4, 5)};
+		Point2 b = {Fraction(-5, 13), Fraction(12, 13)};
+		Point2 c = {Fraction(-15, 17), Fraction(-8, 17)};
+		Point2 d = {Fraction(20, 29), Fraction(-21, 29)};
+		NPASSON_CHECK(orient2d(a, b, c) == 1);
+		NPASSON_CHECK(incircle(a, b, c, d) == 0);
+		Fraction shrink(1000000007, 1000000008), grow(1000000009, 1000000008);
+		NPASSON_CHECK(incircle(a, b, c, Point2{d.x * shrink, d.y * shrink}) == 1);
+		NPASSON_CHECK(incircle(a, b, c, Point2{d.x * grow, d.y * grow}) == -1);
+		NPASSON_CHECK(incircle(b, a, c, d) == 0);
+	}
+
+	void test_segments() {
+		Point2 a = {Fraction(0), Fraction(0)}, b = {Fraction(1, 3), Fraction(1, 7)};
+		Point2 c = {Fraction(2, 3), Fraction(2, 7)}, d = {Fraction(1), Fraction(3, 7)};
+		NPASSON_CHECK(segments_intersect(a, b, b, c));  // touching at an endpoint
+		NPASSON_CHECK(!segments_intersect(a, b, c, d)); // collinear but disjoint
+		NPASSON_CHECK(segments_intersect(a, c, b, d));  // collinear and overlapping
+		Point2 e = {Fraction(1, 3), Fraction(0)}, f = {Fraction(1, 3), Fraction(1)};
+		NPASSON_CHECK(segments_intersect(a, d, e, f));
+	}
+}
+
+int main() {
+	test_orient();
+	test_incircle();
+	test_segments();
+	return test::result();
+}
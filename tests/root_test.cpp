@@ -0,0 +1,96 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file root_test.cpp
+ * Tests of Fraction::root() and Fraction::sqrt() against best approximations computed to 80 digits.
+ */
+
+#include "fraction.hpp"
+#include "test.hpp"
+
+using namespace npasson;
+
+namespace {
+
+	void test_exact() {
+		NPASSON_CHECK(Fraction(49, 81).sqrt() == Fraction(7, 9));
+		NPASSON_CHECK(Fraction(-8, 27).root(3) == Fraction(-2, 3));
+		NPASSON_CHECK(Fraction(1ll << 62, 1).sqrt() == Fraction(1ll << 31, 1));
+		NPASSON_CHECK(Fraction(0).sqrt() == Fraction(0));
+		NPASSON_CHECK(Fraction(5, 7).root(1) == Fraction(5, 7));
+		NPASSON_CHECK(!Fraction(-4).sqrt().valid());
+		NPASSON_CHECK(!Fraction(false).sqrt().valid());
+	}
+
+	void test_extremes() {
+		const long long signed int min = -9223372036854775807ll - 1;
+		NPASSON_CHECK(Fraction(min, 1).root(3) == Fraction(-(1ll << 21), 1));
+		NPASSON_CHECK(Fraction(min, 1).root(63) == Fraction(-2, 1));
+		NPASSON_CHECK(!Fraction(min, 1).sqrt().valid());
+		Fraction negative_den(-27, 8);
+		Fraction::invert(negative_den); // 8/-27
+		NPASSON_CHECK(negative_den.root(3) == Fraction(-2, 3));
+		NPASSON_CHECK(!negative_den.sqrt().valid());
+		Fraction min_den(min, 1);
+		Fraction::invert(min_den); // 1/-2^63
+		NPASSON_CHECK(min_den.root(3) == Fraction(-1, 1ll << 21));
+		Fraction approximate(min, 1);
+		Fraction::invert(approximate);
+		NPASSON_CHECK(approximate.root(5, 100000) == Fraction(-8, 49667)); // -2^(-63/5)
+		NPASSON_CHECK(Fraction(2).root(2, Fraction(-1, 1000)) == Fraction(41, 29));
+	}
+
+	void test_max_denominator() {
+		struct {long long signed int p, q; unsigned int n; long long signed int max, a, b;} cases[] = {
+			{2, 1, 2, 1000, 1393, 985},
+			{3, 1, 2, 1000000, 1694157, 978122},
+			{1, 3, 2, 100, 56, 97},
+			{10, 7, 3, 10000, 7333, 6511},
+			{5, 1, 5, 1000000000, 908181515, 658231493},
+			{123456789, 1000, 2, 1000000000000ll, 22527591102331ll, 64114648564ll},
+		};
+		for (const auto &c : cases) {
+			Fraction root = Fraction(c.p, c.q).root(c.n, c.max);
+			NPASSON_CHECK(root.num() == c.a && root.den() == c.b);
+		}
+	}
+
+	void test_tolerance() {
+		struct {long long signed int p, q; unsigned int n; long long signed int tp, tq, a, b;} cases[] = {
+			{2, 1, 2, 1, 1000, 41, 29},
+			{3, 1, 3, 1, 1000000, 949, 658},
+			{7, 5, 2, 1, 1000000000, 22009, 18601},
+		};
+		for (const auto &c : cases) {
+			Fraction root = Fraction(c.p, c.q).root(c.n, Fraction(c.tp, c.tq));
+			NPASSON_CHECK(root.num() == c.a && root.den() == c.b);
+		}
+	}
+}
+
+int main() {
+	test_exact();
+	test_extremes();
+	test_max_denominator();
+	test_tolerance();
+	return test::result();
+}
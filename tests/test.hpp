@@ -0,0 +1,58 @@
+/*==================================================================================*\
+ *
+ *   Fraction Type
+ *   Copyright (C) 2018  Nicholas Passon
+ *   Documentation: http://www.npasson.com/fractiontype
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+\*==================================================================================*/
+
+/**
+ * \file test.hpp
+ * A minimal check macro for the correctness tests; every test file is its own executable run by ctest.
+ */
+
+#ifndef NPASSON_TEST_HPP
+#define NPASSON_TEST_HPP
+
+#include <cstdio>
+
+namespace npasson {
+	namespace test {
+
+		inline int& failures() {
+			static int count = 0;
+			return count;
+		}
+
+		inline void check(bool passed, const char* expression, const char* file, int line) {
+			if (passed) return;
+			++failures();
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+		}
+
+		/**
+		 * @return The exit code of the test: <tt>0</tt> if every check passed.
+		 */
+		inline int result() {
+			if (failures()) std::fprintf(stderr, "%d checks failed\n", failures());
+			return failures() ? 1 : 0;
+		}
+	}
+}
+
+#define NPASSON_CHECK(expression) ::npasson::test::check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+#endif //NPASSON_TEST_HPP